@@ -0,0 +1,38 @@
+# run the PGO training workload and collect the profile
+#
+# GCC writes one .gcda file per object file, at the absolute path of the
+# object in the instrumented sub-build PGO_DIR; the files are relocated into
+# OBJECT_DIR, where the objects of the optimised build live, by stripping the
+# prefix PGO_DIR and prepending OBJECT_DIR.  Clang writes a raw profile that
+# is merged into PROFILE with llvm-profdata.
+
+if(COMPILER_ID STREQUAL "GNU")
+    file(GLOB_RECURSE old_profiles ${OBJECT_DIR}/CMakeFiles/wigner_objects.dir/*.gcda)
+    if(old_profiles)
+        file(REMOVE ${old_profiles})
+    endif()
+    string(REGEX MATCHALL "[^/]+" components "${PGO_DIR}")
+    list(LENGTH components strip)
+    set(ENV{GCOV_PREFIX} "${OBJECT_DIR}")
+    set(ENV{GCOV_PREFIX_STRIP} "${strip}")
+else()
+    file(REMOVE ${PGO_DIR}/wigner.profraw)
+    set(ENV{LLVM_PROFILE_FILE} "${PGO_DIR}/wigner.profraw")
+endif()
+
+execute_process(COMMAND ${TRAIN} OUTPUT_QUIET RESULT_VARIABLE result)
+if(result)
+    message(FATAL_ERROR "PGO training workload failed: ${result}")
+endif()
+
+if(COMPILER_ID STREQUAL "GNU")
+    file(TOUCH ${PROFILE})
+else()
+    execute_process(
+        COMMAND ${LLVM_PROFDATA} merge -output=${PROFILE}
+                ${PGO_DIR}/wigner.profraw
+        RESULT_VARIABLE result)
+    if(result)
+        message(FATAL_ERROR "llvm-profdata merge failed: ${result}")
+    endif()
+endif()
@@ -1,14 +1,45 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 #include <math.h>
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include "wigner.h"
 
 #ifndef LINELEN
 #define LINELEN 1024
 #endif
 
+#ifndef OUTBUF
+#define OUTBUF (1<<20)
+#endif
+
+// block sizes of the transform in angles and modes
+#ifndef TBLOCK
+#define TBLOCK 16
+#endif
+#ifndef LBLOCK
+#define LBLOCK 512
+#endif
+
+static const char usage[] =
+    "usage: cl_to_xi [-b] [-B] [-c ncl] [-j nthreads] lmin lmax m1 m2 th0 th1 nth\n"
+    "                [file]\n";
+
+// input data, either owned or mapped from a file
+struct input
+{
+    char* buf;
+    size_t len;
+    int mapped;
+};
+
 int cmp(const void* a, const void* b)
 {
     const double* x = a;
@@ -16,24 +47,419 @@ int cmp(const void* a, const void* b)
     return (x[0] > y[0]) - (x[0] < y[0]);
 }
 
-int main(int argc, char* argv[])
+static int little_endian(void)
+{
+    const union { unsigned short s; unsigned char c[2]; } u = { 1 };
+    return u.c[0] == 1;
+}
+
+static void byteswap(double* x, size_t n)
+{
+    unsigned char* c;
+    unsigned char t;
+    size_t i;
+    int j;
+
+    for(i = 0; i < n; ++i)
+    {
+        c = (unsigned char*)&x[i];
+        for(j = 0; j < 4; ++j)
+            t = c[j], c[j] = c[7-j], c[7-j] = t;
+    }
+}
+
+// digits of the text output
+#define NDIG 19
+#define DMIN 1000000000000000000ULL
+
+// format x as printf("%.18e") does and return the number of characters; the
+// digits of x = m 2^q are found exactly as round(m 5^k 2^(q+k)) for k = 18-e
+// in 128-bit arithmetic, and all other values are passed to snprintf
+static int format_e(double x, char* s)
+{
+#ifdef __SIZEOF_INT128__
+    __extension__ typedef unsigned __int128 u128;
+    u128 n, r, p;
+    unsigned long long m, dig;
+    double a;
+    int q, e, k, i, t;
+    char* c;
+
+    a = fabs(x);
+    if(a >= 1e-9 && a < 1e18)
+    {
+        m = (unsigned long long)ldexp(frexp(a, &q), 53);
+        q -= 53;
+        e = (int)floor(log10(a));
+        for(t = 0; t < 4; ++t)
+        {
+            k = NDIG-1 - e;
+            for(p = 1, i = 0; i < k; ++i)
+                p *= 5;
+            n = m*p;
+            if(q + k >= 0)
+                n <<= q + k;
+            else
+            {
+                i = -(q + k);
+                r = n & (((u128)1 << i) - 1);
+                p = (u128)1 << (i-1);
+                n >>= i;
+                n += r > p || (r == p && (n & 1));
+            }
+            if(n >= 10*DMIN)
+                e += 1;
+            else if(n < DMIN)
+                e -= 1;
+            else
+                break;
+        }
+        if(t < 4)
+        {
+            dig = (unsigned long long)n;
+            c = s;
+            if(x < 0)
+                *c++ = '-';
+            c[0] = '0' + (char)(dig/DMIN);
+            c[1] = '.';
+            for(i = NDIG; i > 1; --i, dig /= 10)
+                c[i] = '0' + (char)(dig % 10);
+            c += NDIG+1;
+            *c++ = 'e';
+            *c++ = e < 0 ? '-' : '+';
+            e = abs(e);
+            *c++ = '0' + (char)(e/10);
+            *c++ = '0' + (char)(e%10);
+            return (int)(c - s);
+        }
+    }
+#endif
+    return snprintf(s, 32, "%.18e", x);
+}
+
+// map a regular file into memory, or read a stream until EOF
+static int read_input(int fd, struct input* in)
 {
-    int l, l0, l1, m1, m2, nt, n, i;
-    double t, t0, t1, x, d;
-    FILE* fp;
-    char buf[LINELEN];
-    char* ell;
-    char* c_l;
+    struct stat st;
+    size_t cap;
+    ssize_t r;
+    char* tmp;
+
+    if(fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0)
+    {
+        in->len = st.st_size;
+        in->buf = mmap(NULL, in->len, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(in->buf != MAP_FAILED)
+        {
+            in->mapped = 1;
+            return 0;
+        }
+    }
+
+    in->mapped = 0;
+    in->len = 0;
+    cap = 1<<16;
+    in->buf = malloc(cap);
+    if(!in->buf)
+        return -1;
+    while((r = read(fd, in->buf + in->len, cap - in->len)) != 0)
+    {
+        if(r < 0)
+            return -1;
+        in->len += r;
+        if(in->len == cap)
+        {
+            cap *= 2;
+            tmp = realloc(in->buf, cap);
+            if(!tmp)
+                return -1;
+            in->buf = tmp;
+        }
+    }
+    return 0;
+}
+
+static void free_input(struct input* in)
+{
+    if(in->mapped)
+        munmap(in->buf, in->len);
+    else
+        free(in->buf);
+}
+
+// parse the header of a .npy file and return the offset of the data
+static size_t npy_header(const char* buf, size_t len, size_t* rows,
+                         size_t* cols, int* fortran)
+{
+    size_t off, hlen;
+    const char* h;
+    const char* s;
+    char hdr[LINELEN];
+
+    if(buf[6] == 1)
+    {
+        hlen = (unsigned char)buf[8] | (size_t)(unsigned char)buf[9] << 8;
+        off = 10;
+    }
+    else
+    {
+        hlen = (unsigned char)buf[8] | (size_t)(unsigned char)buf[9] << 8
+             | (size_t)(unsigned char)buf[10] << 16
+             | (size_t)(unsigned char)buf[11] << 24;
+        off = 12;
+    }
+
+    if(hlen >= sizeof(hdr) || off + hlen > len)
+    {
+        fprintf(stderr, "error: invalid .npy header\n");
+        return 0;
+    }
+    memcpy(hdr, buf + off, hlen);
+    hdr[hlen] = '\0';
+    h = hdr;
+
+    s = strstr(h, "'descr':");
+    if(!s || !strstr(s, "'<f8'"))
+    {
+        fprintf(stderr, "error: .npy input must have dtype '<f8'\n");
+        return 0;
+    }
+    s = strstr(h, "'fortran_order':");
+    if(!s)
+    {
+        fprintf(stderr, "error: invalid .npy header\n");
+        return 0;
+    }
+    *fortran = strncmp(s + 16 + strspn(s + 16, " "), "True", 4) == 0;
+    s = strstr(h, "'shape':");
+    if(!s || sscanf(s + 8, " (%zu, %zu)", rows, cols) != 2 || *cols < 2)
+    {
+        fprintf(stderr, "error: .npy input must have shape (n, 1+ncl)\n");
+        return 0;
+    }
+
+    off += hlen;
+    if(off + *rows**cols*sizeof(double) > len)
+    {
+        fprintf(stderr, "error: .npy input is truncated\n");
+        return 0;
+    }
+    return off;
+}
+
+// parse a number, with a fast path for plain integers such as `l`
+static double parse_num(const char* p, char** end)
+{
+    const char* q = p;
+    double x = 0;
+
+    while(*q >= '0' && *q <= '9' && q - p < 15)
+        x = 10*x + (*q++ - '0');
+    if(q > p && (*q == ' ' || *q == '\t' || *q == '\r' || *q == '\0'))
+    {
+        *end = (char*)q;
+        return x;
+    }
+    return strtod(p, end);
+}
+
+// parse "l C_l ..." rows of text into a newly allocated array
+static double* parse_text(const char* buf, size_t len, size_t* rows,
+                          size_t* cols)
+{
+    const char* end = buf + len;
+    const char* eol;
+    char* line;
+    char* p;
+    char* q;
     double* l_cl;
-    double* cl;
+    double* tmp;
+    size_t i, n, k, c, m;
+    int l;
+
+    c = 0;
+    i = 1024;
+    m = LINELEN;
+    l_cl = malloc(i*2*sizeof(double));
+    line = malloc(m);
+    if(!l_cl || !line)
+        perror(NULL), abort();
+
+    for(l = 1, n = 0; buf < end; buf = eol + 1, ++l)
+    {
+        eol = memchr(buf, '\n', end - buf);
+        if(!eol)
+            eol = end;
+
+        // lines are copied so that parsing stops at the end of the input
+        k = eol - buf;
+        if(k >= m)
+        {
+            m = k + 1;
+            free(line);
+            line = malloc(m);
+            if(!line)
+                perror(NULL), abort();
+        }
+        memcpy(line, buf, k);
+        line[k] = '\0';
+
+        p = line + strspn(line, " \t\r");
+        if(!*p || *p == '#')
+            continue;
+
+        // the first row determines the number of columns
+        if(c == 0)
+        {
+            for(q = p; *q && *q != '#'; ++c)
+            {
+                q += strcspn(q, " \t\r");
+                q += strspn(q, " \t\r");
+            }
+            if(c < 2)
+            {
+                fprintf(stderr, "error: line %d: missing `C_l` value\n", l);
+                exit(EXIT_FAILURE);
+            }
+            l_cl = realloc(l_cl, i*c*sizeof(double));
+            if(!l_cl)
+                perror(NULL), abort();
+        }
+
+        if(n == i)
+        {
+            i *= 2;
+            tmp = realloc(l_cl, i*c*sizeof(double));
+            if(!tmp)
+                perror(NULL), abort();
+            l_cl = tmp;
+        }
+
+        l_cl[n*c] = parse_num(p, &q);
+        for(k = 1; k < c; ++k)
+        {
+            p = q + strspn(q, " \t\r");
+            if(!*p || *p == '#')
+            {
+                fprintf(stderr, "error: line %d: missing `C_l` value\n", l);
+                exit(EXIT_FAILURE);
+            }
+            l_cl[n*c+k] = parse_num(p, &q);
+        }
+        n += 1;
+    }
+
+    free(line);
+
+    *rows = n;
+    *cols = c;
+    return l_cl;
+}
+
+// xi[t][k] += sum_l d[t][l] w[l][k] for a block of angles
+static void transform(int nt, int nl, int nk, const double* d, int ldd,
+                      const double* w, double* xi)
+{
+    int t, l, lb, le, k;
+    double dv;
+
+    for(lb = 0; lb < nl; lb += LBLOCK)
+    {
+        le = lb + LBLOCK < nl ? lb + LBLOCK : nl;
+        for(t = 0; t < nt; ++t)
+        {
+            for(l = lb; l < le; ++l)
+            {
+                dv = d[t*ldd+l];
+                for(k = 0; k < nk; ++k)
+                    xi[t*nk+k] += dv*w[l*nk+k];
+            }
+        }
+    }
+}
+
+// one block of angles of the transform, computed as a task of the execution
+// context with its own buffer of d-functions
+struct blocks
+{
+    int l0, l1, m1, m2, nt, nl, nk;
+    double t0, dt;
+    const double* cl;
+    double* xi;
+};
+
+static void transform_block(void* arg, int task)
+{
+    const struct blocks* b = arg;
+    int i, j, nb;
     double* wd;
-    
+
+    i = task*TBLOCK;
+    nb = b->nt - i < TBLOCK ? b->nt - i : TBLOCK;
+
+    wd = malloc((size_t)nb*b->nl*sizeof(double));
+    if(!wd)
+        perror(NULL), abort();
+
+    for(j = 0; j < nb; ++j)
+        wigner_dl(b->l0, b->l1, b->m1, b->m2,
+                  0.017453292519943295769*(b->t0 + b->dt*(i+j)),
+                  wd + (size_t)j*b->nl);
+    transform(nb, b->nl, b->nk, wd, b->nl, b->cl, b->xi + (size_t)i*b->nk);
+
+    free(wd);
+}
+
+int main(int argc, char* argv[])
+{
+    int l, l0, l1, m1, m2, nt, nl, nk, nj, i, j, opt, binin, binout, fd, fo,
+        swap;
+    size_t n, c, off, k, r;
+    double t0, t1, d;
+    struct input in;
+    struct blocks blk;
+    struct wigner_exec exec;
+    const double* l_cl;
+    double* own;
+    double* cl;
+    double* xi;
+    double* out;
+    char* row;
+    char* p;
+
+    binin = binout = 0;
+    nk = 1;
+    nj = 0;
+    while((opt = getopt(argc, argv, "bBc:j:")) != -1)
+    {
+        switch(opt)
+        {
+        case 'b':
+            binin = 1;
+            break;
+        case 'B':
+            binout = 1;
+            break;
+        case 'c':
+            nk = atoi(optarg);
+            break;
+        case 'j':
+            nj = atoi(optarg);
+            break;
+        default:
+            fputs(usage, stderr);
+            return EXIT_FAILURE;
+        }
+    }
+    argc -= optind-1;
+    argv += optind-1;
+
     if(argc < 8 || argc > 9)
     {
-        fprintf(stderr, "usage: cl_to_xi lmin lmax m1 m2 th0 th1 nth [file]\n");
+        fputs(usage, stderr);
         return EXIT_FAILURE;
     }
-    
+
     l0 = atoi(argv[1]);
     l1 = atoi(argv[2]);
     m1 = atoi(argv[3]);
@@ -41,114 +467,205 @@ int main(int argc, char* argv[])
     t0 = atof(argv[5]);
     t1 = atof(argv[6]);
     nt = atoi(argv[7]);
-    
+
     if(l0 < 0 || l1 < l0)
     {
         fprintf(stderr, "error: 0 <= lmin <= lmax required\n");
         return EXIT_FAILURE;
     }
-    
+
     if(t0 < 0 || t1 < t0)
     {
         fprintf(stderr, "error: 0 <= th0 <= th1 required\n");
         return EXIT_FAILURE;
     }
-    
+
     if(nt < 2)
     {
         fprintf(stderr, "error: nth > 1 required\n");
         return EXIT_FAILURE;
     }
-    
-    fp = argc > 8 ? fopen(argv[8], "r") : stdin;
-    if(!fp)
+
+    if(nk < 1)
+    {
+        fprintf(stderr, "error: ncl > 0 required\n");
+        return EXIT_FAILURE;
+    }
+
+    fd = argc > 8 ? open(argv[8], O_RDONLY) : STDIN_FILENO;
+    if(fd < 0 || read_input(fd, &in) != 0)
     {
         perror(NULL);
         return EXIT_FAILURE;
     }
-    
-    i = 1;
-    l_cl = malloc(i*2*sizeof(double));
-    if(!l_cl)
-        perror(NULL), abort();
-    
-    for(l = 1, n = 0; fgets(buf, sizeof(buf), fp); ++l)
+
+    if(fd != STDIN_FILENO)
+        close(fd);
+
+    // binary and .npy input is used in place whenever possible, and is
+    // little-endian, unlike parsed text, which is in native order
+    own = NULL;
+    swap = 0;
+    if(in.len >= 12 && memcmp(in.buf, "\x93NUMPY", 6) == 0)
     {
-        ell = strtok(buf, " \t\r\n");
-        c_l = strtok(NULL, " \t\r\n");
-        
-        if(!ell || *ell == '#')
-            continue;
-        
-        if(!c_l || *c_l == '#')
-        {
-            fprintf(stderr, "error: line %d: missing `C_l` value\n", l);
+        off = npy_header(in.buf, in.len, &n, &c, &fo);
+        if(!off)
             return EXIT_FAILURE;
-        }
-        
-        if(n == i)
+        l_cl = (const double*)(in.buf + off);
+        swap = !little_endian();
+
+        // column-major arrays are transposed into rows
+        if(fo)
         {
-            i *= 2;
-            l_cl = realloc(l_cl, i*2*sizeof(double));
-            if(!l_cl)
+            own = malloc(n*c*sizeof(double));
+            if(!own)
                 perror(NULL), abort();
+            for(r = 0; r < n; ++r)
+                for(k = 0; k < c; ++k)
+                    own[r*c+k] = l_cl[k*n+r];
+            l_cl = own;
         }
-        
-        l_cl[n*2+0] = atof(ell);
-        l_cl[n*2+1] = atof(c_l);
-        n += 1;
     }
-    
-    if(fp != stdin)
-        fclose(fp);
-    
+    else if(binin)
+    {
+        c = nk + 1;
+        if(in.len % (c*sizeof(double)) != 0)
+        {
+            fprintf(stderr, "error: binary input must contain rows of %zu doubles\n", c);
+            return EXIT_FAILURE;
+        }
+        n = in.len/(c*sizeof(double));
+        l_cl = (const double*)in.buf;
+        swap = !little_endian();
+    }
+    else
+    {
+        own = parse_text(in.buf, in.len, &n, &c);
+        l_cl = own;
+    }
+
     if(n < 2)
     {
         fprintf(stderr, "error: needs at least two entries\n");
         return EXIT_FAILURE;
     }
-    
-    qsort(l_cl, n, 2*sizeof(double), cmp);
-    
-    cl = malloc((l1-l0+1)*sizeof(double));
-    wd = malloc((l1-l0+1)*sizeof(double));
-    if(!cl || !wd)
-        perror(NULL), abort();
-    
-    l = l0;
-    if(l_cl[0] > l)
+
+    if(swap)
     {
-        d = (l_cl[3] - l_cl[1])/(l_cl[2] - l_cl[0]);
-        for(; l < l_cl[0]; ++l)
-            cl[l-l0] = l_cl[1] + d*(l - l_cl[0]);
+        if(l_cl != own)
+        {
+            own = malloc(n*c*sizeof(double));
+            if(!own)
+                perror(NULL), abort();
+            memcpy(own, l_cl, n*c*sizeof(double));
+            l_cl = own;
+        }
+        byteswap(own, n*c);
     }
-    for(i = 1; l <= l1; ++l)
+
+    for(r = 1; r < n && l_cl[(r-1)*c] <= l_cl[r*c]; ++r) {}
+    if(r < n)
     {
-        while(i < n && l_cl[2*i] < l)
-            ++i;
-        d = (l_cl[2*i+1] - l_cl[2*i-1])/(l_cl[2*i] - l_cl[2*i-2]);
-        cl[l-l0] = l_cl[2*i+1] + d*(l - l_cl[2*i]);
+        if(l_cl != own)
+        {
+            own = malloc(n*c*sizeof(double));
+            if(!own)
+                perror(NULL), abort();
+            memcpy(own, l_cl, n*c*sizeof(double));
+            l_cl = own;
+        }
+        qsort(own, n, c*sizeof(double), cmp);
+    }
+
+    // interpolated spectra with the transform weights (2l+1)/(4pi) applied
+    nk = c - 1;
+    nl = l1 - l0 + 1;
+    cl = malloc((size_t)nl*nk*sizeof(double));
+    xi = malloc((size_t)nt*nk*sizeof(double));
+    if(!cl || !xi)
+        perror(NULL), abort();
+
+    for(l = l0, r = 1; l <= l1; ++l)
+    {
+        while(r < n-1 && l_cl[r*c] < l)
+            ++r;
+        for(k = 1; k < c; ++k)
+        {
+            d = (l_cl[r*c+k] - l_cl[(r-1)*c+k])/(l_cl[r*c] - l_cl[(r-1)*c]);
+            cl[(l-l0)*nk+k-1] = 0.079577471545947667884*(2*l+1)
+                                        *(l_cl[r*c+k] + d*(l - l_cl[r*c]));
+        }
     }
-    
-    printf("# %-22s  %-s\n", "theta [deg]", "xi");
-    
+
+    free(own);
+    free_input(&in);
+
+    // each row of d-functions is computed once and applied to all spectra,
+    // and the blocks of angles are computed in parallel
+    memset(xi, 0, (size_t)nt*nk*sizeof(double));
     d = (t1 - t0)/(nt - 1);
-    for(i = 0; i < nt; ++i)
-    {
-        t = t0 + d*i;
-        
-        wigner_dl(l0, l1, m1, m2, 0.017453292519943295769*t, wd);
-        
-        x = 0;
-        for(l = l0; l <= l1; ++l)
-            x += 0.079577471545947667884*(2*l+1)*cl[l-l0]*wd[l-l0];
-        
-        printf("%.18e  %.18e\n", t, x);
-    }
-    
+    blk.l0 = l0;
+    blk.l1 = l1;
+    blk.m1 = m1;
+    blk.m2 = m2;
+    blk.nt = nt;
+    blk.nl = nl;
+    blk.nk = nk;
+    blk.t0 = t0;
+    blk.dt = d;
+    blk.cl = cl;
+    blk.xi = xi;
+    wigner_exec_init(&exec, nj);
+    wigner_exec_run(&exec, (nt + TBLOCK-1)/TBLOCK, transform_block, &blk);
+
+    setvbuf(stdout, NULL, _IOFBF, OUTBUF);
+
+    if(binout)
+    {
+        out = malloc((nk+1)*sizeof(double));
+        if(!out)
+            perror(NULL), abort();
+        for(i = 0; i < nt; ++i)
+        {
+            out[0] = t0 + d*i;
+            memcpy(out+1, xi + (size_t)i*nk, nk*sizeof(double));
+            if(!little_endian())
+                byteswap(out, nk+1);
+            fwrite(out, sizeof(double), nk+1, stdout);
+        }
+        free(out);
+    }
+    else
+    {
+        printf("# %-22s", "theta [deg]");
+        if(nk == 1)
+            printf("  %-s", "xi");
+        else
+            for(k = 0; k < (size_t)nk; ++k)
+                printf("  xi_%-20zu", k+1);
+        printf("\n");
+
+        // each row is formatted into a buffer and written at once
+        row = malloc(((size_t)nk+1)*32 + 1);
+        if(!row)
+            perror(NULL), abort();
+        for(i = 0; i < nt; ++i)
+        {
+            p = row + format_e(t0 + d*i, row);
+            for(j = 0; j < nk; ++j)
+            {
+                *p++ = ' ';
+                *p++ = ' ';
+                p += format_e(xi[(size_t)i*nk+j], p);
+            }
+            *p++ = '\n';
+            fwrite(row, 1, p - row, stdout);
+        }
+        free(row);
+    }
+
     free(cl);
-    free(wd);
-    free(l_cl);
-    
+    free(xi);
+
     return EXIT_SUCCESS;
 }
@@ -1,14 +1,247 @@
 #pragma once
 
+#include <stddef.h>
+
 void legendre_pl(int lmin, int lmax, double x, double* p);
 
 int wigner_3jj(double l2, double l3, double m2, double m3, double* l1min,
                double* l1max, double* thrcof, int ndim);
 
+int wigner_3jj_int(int l2, int l3, int m2, int m3, int* l1min, int* l1max,
+                   double* thrcof, int ndim);
+
+int wigner_3jj_twoj(int two_l2, int two_l3, int two_m2, int two_m3,
+                    int* two_l1min, int* two_l1max, double* thrcof, int ndim);
+
 int wigner_3jm(double l1, double l2, double l3, double m1, double* m2min,
                double* m2max, double* thrcof, int ndim);
 
+int wigner_3jm_int(int l1, int l2, int l3, int m1, int* m2min, int* m2max,
+                   double* thrcof, int ndim);
+
+int wigner_3jm_twoj(int two_l1, int two_l2, int two_l3, int two_m1,
+                    int* two_m2min, int* two_m2max, double* thrcof, int ndim);
+
+int wigner_3j_block(int l1, int l2, int l3, double* out);
+
+int clebsch_gordan_block(int l1, int l2, int l3, double* out);
+
 int wigner_6j(double l2, double l3, double l4, double l5, double l6,
               double* l1min, double* l1max, double* sixcof, int ndim);
 
+int wigner_6j_int(int l2, int l3, int l4, int l5, int l6, int* l1min,
+                  int* l1max, double* sixcof, int ndim);
+
+int wigner_6j_twoj(int two_l2, int two_l3, int two_l4, int two_l5, int two_l6,
+                   int* two_l1min, int* two_l1max, double* sixcof, int ndim);
+
+double wigner_3j_single(double l1, double l2, double l3, double m1, double m2,
+                        double m3);
+
+double wigner_6j_single(double l1, double l2, double l3, double l4, double l5,
+                        double l6);
+
+typedef void wigner_task(void* arg, int task);
+
+typedef void wigner_scheduler(void* sched, int ntasks, wigner_task* task,
+                              void* arg);
+
+struct wigner_exec
+{
+    int nthreads;
+    wigner_scheduler* run;
+    void* sched;
+};
+
+void wigner_exec_init(struct wigner_exec* exec, int nthreads);
+
+void wigner_exec_external(struct wigner_exec* exec, int nworkers,
+                          wigner_scheduler* run, void* sched);
+
+int wigner_exec_threads(const struct wigner_exec* exec);
+
+void wigner_exec_run(const struct wigner_exec* exec, int ntasks,
+                     wigner_task* task, void* arg);
+
+typedef int wigner_try_task(void* arg, int task);
+
+int wigner_exec_try(const struct wigner_exec* exec, int ntasks,
+                    wigner_try_task* task, void* arg);
+
+size_t wigner_3jj_batch_size(int n, const double* l2, const double* l3,
+                             const double* m2, const double* m3,
+                             size_t* offsets);
+
+int wigner_3jj_batch(int n, const double* l2, const double* l3,
+                     const double* m2, const double* m3,
+                     const size_t* offsets, double* l1min, double* thrcof,
+                     int* ier);
+
+int wigner_3jj_batch_exec(int n, const double* l2, const double* l3,
+                          const double* m2, const double* m3,
+                          const size_t* offsets, double* l1min,
+                          double* thrcof, int* ier,
+                          const struct wigner_exec* exec);
+
+size_t wigner_6j_batch_size(int n, const double* l2, const double* l3,
+                            const double* l4, const double* l5,
+                            const double* l6, size_t* offsets);
+
+int wigner_6j_batch(int n, const double* l2, const double* l3,
+                    const double* l4, const double* l5, const double* l6,
+                    const size_t* offsets, double* l1min, double* sixcof,
+                    int* ier);
+
+int wigner_6j_batch_exec(int n, const double* l2, const double* l3,
+                         const double* l4, const double* l5,
+                         const double* l6, const size_t* offsets,
+                         double* l1min, double* sixcof, int* ier,
+                         const struct wigner_exec* exec);
+
+size_t wigner_3j000_size(int lmax);
+
+size_t wigner_3j000_index(int l1, int l2, int l3);
+
+int wigner_3j000_fill(int lmax, double* t, const struct wigner_exec* exec);
+
+double wigner_3j000_get(int lmax, const double* t, int l1, int l2, int l3);
+
+const double* wigner_3j000_row(const double* t, int l2, int l3, int* l1min,
+                               int* l1max);
+
+int wigner_3j000_binned(int nbins, const int* edges, const double* w1,
+                        const double* w2, const double* w3, double* out,
+                        const struct wigner_exec* exec);
+
+struct wigner_3j000_iter
+{
+    int l1, l2, l3;
+    size_t i;
+};
+
+void wigner_3j000_first(struct wigner_3j000_iter* it);
+
+void wigner_3j000_next(struct wigner_3j000_iter* it);
+
 void wigner_dl(int lmin, int lmax, int m1, int m2, double theta, double* d);
+
+struct wigner_dl_state
+{
+    int m1, m2, lp, l;
+    double x, dlp, d1, d2, s1;
+};
+
+void wigner_dl_init(struct wigner_dl_state* state, int m1, int m2,
+                    double theta);
+
+void wigner_dl_advance(struct wigner_dl_state* state, int nl, double* d);
+
+void wigner_dl_segmented(int lmin, int lmax, int m1, int m2, double theta,
+                         double* d);
+
+void wigner_dl_segmented_exec(int lmin, int lmax, int m1, int m2,
+                              double theta, double* d,
+                              const struct wigner_exec* exec);
+
+void wigner_dl_multi(int lmin, int lmax, int nspin, const int* m1,
+                     const int* m2, double theta, int interleave, double* d);
+
+void wigner_dl_batch(int lmin, int lmax, int m1, int m2, int n,
+                     const double* theta, double* d,
+                     const struct wigner_exec* exec);
+
+enum
+{
+    WIGNER_ALM_HEALPIX,
+    WIGNER_ALM_LM
+};
+
+size_t wigner_alm_size(int order, int lmax);
+
+size_t wigner_alm_index(int order, int lmax, int l, int m);
+
+int spin_ylm(int s, int lmax, int order, int n, const double* theta,
+             const double* phi, double* y, const struct wigner_exec* exec);
+
+int spin_synth(int s, int lmax, int order, const double* alm, int n,
+               const double* theta, const double* phi, double* f,
+               const struct wigner_exec* exec);
+
+int rotate_alm(int lmax, int order, double alpha, double beta, double gamma,
+               double* alm, const struct wigner_exec* exec);
+
+void legendre_pl_deriv(int lmin, int lmax, double x, double* p, double* dp);
+
+void wigner_dl_deriv(int lmin, int lmax, int m1, int m2, double theta,
+                     double* d, double* dd);
+
+void legendre_pl_binavg(int lmin, int lmax, double xa, double xb, double* p);
+
+enum
+{
+    LEGENDRE_PLM_ORTHO,
+    LEGENDRE_PLM_SCHMIDT,
+    LEGENDRE_PLM_UNNORM
+};
+
+int legendre_plm(int lmax, int m, int norm, int n, const double* x,
+                 double* p, const struct wigner_exec* exec);
+
+int legendre_plm_all(int lmax, int norm, int n, const double* x, double* p,
+                     const struct wigner_exec* exec);
+
+typedef void legendre_pl_tile(void* arg, int i0, int ni, int l0, int nl,
+                              const double* p);
+
+int legendre_pl_tiles(int lmax, int n, const double* x, int xblock,
+                      int lblock, legendre_pl_tile* tile, void* arg,
+                      const struct wigner_exec* exec);
+
+int wigner_dl_binavg(int lmin, int lmax, int m1, int m2, double theta_a,
+                     double theta_b, double* d);
+
+struct wigner_dl_binavg_plan
+{
+    int lmax, n;
+    double width;
+    double* x;
+    double* w;
+    double* dl;
+};
+
+int wigner_dl_binavg_init(struct wigner_dl_binavg_plan* plan, int lmax,
+                          double width);
+
+int wigner_dl_binavg_apply(struct wigner_dl_binavg_plan* plan, int lmin,
+                           int lmax, int m1, int m2, double theta_a,
+                           double theta_b, double* d);
+
+void wigner_dl_binavg_free(struct wigner_dl_binavg_plan* plan);
+
+void gauss_legendre(int n, double* x, double* w);
+
+void gauss_legendre_exec(int n, double* x, double* w,
+                         const struct wigner_exec* exec);
+
+enum
+{
+    WIGNER_STATS_3JJ,
+    WIGNER_STATS_3JM,
+    WIGNER_STATS_6J,
+    WIGNER_STATS_N
+};
+
+struct wigner_stats
+{
+    long long calls;
+    long long coefs;
+    long long rescales;
+    long long fwd_steps;
+    long long bwd_steps;
+    long long nobac;
+    long long zeroed;
+};
+
+int wigner_stats_get(int routine, struct wigner_stats* stats);
+
+void wigner_stats_reset(void);
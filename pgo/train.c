@@ -0,0 +1,155 @@
+// training workload for profile-guided optimisation
+//
+// notes:
+// - runs a fixed mix of calls that is representative of typical use: rows
+//   of 3j and 6j symbols for small and large l, including the strongly
+//   decaying rows that trigger rescaling and threshold zeroing, and rows of
+//   d-functions for the spin combinations and angles used by cl_to_xi
+// - the workload is deterministic and takes about half a second when built
+//   with instrumentation, and the checksum is printed so the calls cannot be
+//   optimised away
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+
+#include "wigner.h"
+
+// largest l in the rows of 3j and 6j symbols
+#define TRAIN_LMAX 2000
+
+// largest l and number of angles of the d-function rows
+#define TRAIN_DL_LMAX 3000
+#define TRAIN_DL_NTH 200
+
+// number of repetitions of the whole workload
+#define TRAIN_REPEAT 10
+
+static double train_3j(double* buf)
+{
+    int l2, l3, m2, m3, k;
+    double l1min, l1max, sum = 0;
+
+    // many short rows at small l
+    for(l2 = 0; l2 <= 40; ++l2)
+        for(l3 = 0; l3 <= 40; ++l3)
+            for(m2 = -2; m2 <= 2; ++m2)
+                for(m3 = -2; m3 <= 2; m3 += 2)
+                    if(!wigner_3jj(l2, l3, m2, m3, &l1min, &l1max, buf,
+                                   2*TRAIN_LMAX+1))
+                        sum += buf[0];
+
+    // long rows at large l, with m = 0 and spins, and with l2 >> l3 where
+    // the symbols decay by many orders of magnitude
+    for(k = 1; k <= 20; ++k)
+    {
+        l2 = k*TRAIN_LMAX/20;
+        for(l3 = l2/4; l3 <= l2; l3 += l2/4)
+        {
+            for(m2 = -2; m2 <= 2; m2 += 2)
+                if(!wigner_3jj(l2, l3, m2, -m2, &l1min, &l1max, buf,
+                               2*TRAIN_LMAX+1))
+                    sum += buf[(int)(l1max-l1min)/2];
+            if(!wigner_3jj(l2, 10, l2/2, 0, &l1min, &l1max, buf,
+                           2*TRAIN_LMAX+1))
+                sum += buf[0];
+        }
+    }
+
+    // stretched rows which span hundreds of orders of magnitude, so that
+    // the recursions rescale and zero many coefficients
+    for(k = 1; k <= 10; ++k)
+    {
+        l2 = k*TRAIN_LMAX/20;
+        if(!wigner_3jj(l2, l2, l2, -l2, &l1min, &l1max, buf, 2*TRAIN_LMAX+1))
+            sum += buf[0];
+        if(!wigner_3jm(l2, l2, l2, 0, &l1min, &l1max, buf, 2*TRAIN_LMAX+1))
+            sum += buf[l2];
+    }
+
+    // rows in m2
+    for(k = 1; k <= 40; ++k)
+    {
+        l2 = 25*k;
+        if(!wigner_3jm(l2, l2+3, 7, 2, &l1min, &l1max, buf, 2*TRAIN_LMAX+1))
+            sum += buf[0];
+    }
+
+    return sum;
+}
+
+static double train_6j(double* buf)
+{
+    int l2, l3, k;
+    double l1min, l1max, sum = 0;
+
+    for(l2 = 0; l2 <= 30; ++l2)
+        for(l3 = 0; l3 <= 30; l3 += 3)
+            if(!wigner_6j(l2, l3, 5, 7, 11, &l1min, &l1max, buf,
+                          2*TRAIN_LMAX+1))
+                sum += buf[0];
+
+    for(k = 1; k <= 20; ++k)
+    {
+        l2 = k*TRAIN_LMAX/40;
+        if(!wigner_6j(l2, l2+5, l2, l2+10, 3*l2/4, &l1min, &l1max, buf,
+                      2*TRAIN_LMAX+1))
+            sum += buf[0];
+        if(!wigner_6j(l2, 2*l2, 10, 2*l2+5, l2+3, &l1min, &l1max, buf,
+                      2*TRAIN_LMAX+1))
+            sum += buf[0];
+        if(!wigner_6j(l2, l2, l2, l2, l2, &l1min, &l1max, buf,
+                      2*TRAIN_LMAX+1))
+            sum += buf[0];
+    }
+
+    return sum;
+}
+
+static double train_dl(double* buf)
+{
+    // spins of the two-point functions computed by cl_to_xi
+    static const int spins[][2] = { {0, 0}, {0, 2}, {2, 2}, {2, -2} };
+
+    int i, j;
+    double t, sum = 0;
+
+    for(i = 0; i < 4; ++i)
+    {
+        for(j = 0; j < TRAIN_DL_NTH; ++j)
+        {
+            // angles from arcminutes to degrees, as in cl_to_xi
+            t = 0.00029088820866572158*pow(12000., (j+0.5)/TRAIN_DL_NTH);
+            wigner_dl(0, TRAIN_DL_LMAX, spins[i][0], spins[i][1], t, buf);
+            sum += buf[TRAIN_DL_LMAX];
+        }
+    }
+
+    legendre_pl(0, TRAIN_DL_LMAX, 0.3, buf);
+    sum += buf[TRAIN_DL_LMAX];
+
+    return sum;
+}
+
+int main(void)
+{
+    int i;
+    double sum;
+    double* buf;
+
+    buf = malloc((TRAIN_DL_LMAX+1 > 2*TRAIN_LMAX+1 ? TRAIN_DL_LMAX+1
+                                                  : 2*TRAIN_LMAX+1)
+                 * sizeof(double));
+    if(!buf)
+        return EXIT_FAILURE;
+
+    sum = 0;
+    for(i = 0; i < TRAIN_REPEAT; ++i)
+        sum += train_3j(buf) + train_6j(buf) + train_dl(buf);
+
+    printf("%.17g\n", sum);
+
+    free(buf);
+
+    return EXIT_SUCCESS;
+}
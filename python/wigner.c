@@ -3,9 +3,46 @@
 #include <Python.h>
 #include <numpy/arrayobject.h>
 
+#include <limits.h>
+
 #include "wigner.h"
 
 
+// convert obj to a one-dimensional array of int, from any sequence or array
+// of integers, which must be in the range of int
+static PyArrayObject* int_array(PyObject* obj, const char* name)
+{
+    PyArrayObject* a;
+    PyArrayObject* b;
+    const long long* p;
+    npy_intp i, n;
+
+    a = (PyArrayObject*)PyArray_FROMANY(obj, NPY_LONGLONG, 1, 1,
+                                        NPY_ARRAY_IN_ARRAY);
+    if(!a)
+        return NULL;
+
+    n = PyArray_DIM(a, 0);
+    p = PyArray_DATA(a);
+    for(i = 0; i < n; ++i)
+    {
+        if(p[i] < INT_MIN || p[i] > INT_MAX)
+        {
+            Py_DECREF(a);
+            return (PyArrayObject*)PyErr_Format(PyExc_OverflowError,
+                                                "%s out of range", name);
+        }
+    }
+
+    b = (PyArrayObject*)PyArray_FROMANY((PyObject*)a, NPY_INT, 1, 1,
+                                        NPY_ARRAY_IN_ARRAY
+                                        | NPY_ARRAY_FORCECAST);
+    Py_DECREF(a);
+
+    return b;
+}
+
+
 static PyObject* _legendre_pl(PyObject* self, PyObject* args)
 {
     int lmin, lmax, n;
@@ -119,6 +156,191 @@ static PyObject* _wigner_3jm(PyObject* self, PyObject* args)
 }
 
 
+static PyObject* _wigner_3j_block(PyObject* self, PyObject* args)
+{
+    int l1, l2, l3;
+    npy_intp dims[2];
+    PyArrayObject* array;
+
+    if(!PyArg_ParseTuple(args, "iii", &l1, &l2, &l3))
+        return NULL;
+
+    if((l1+l2-l3 < 0) || (l1-l2+l3 < 0) || (-l1+l2+l3 < 0))
+        return PyErr_Format(PyExc_ValueError, "`abs(l1-l2) <= l3 <= l1+l2` not satisfied");
+
+    dims[0] = 2*l1+1;
+    dims[1] = 2*l2+1;
+    array = (PyArrayObject*)PyArray_SimpleNew(2, dims, NPY_DOUBLE);
+    if(!array)
+        return NULL;
+
+    wigner_3j_block(l1, l2, l3, PyArray_DATA(array));
+
+    return PyArray_Return(array);
+}
+
+
+static PyObject* _wigner_3j000(PyObject* self, PyObject* args)
+{
+    int lmax, ier;
+    npy_intp dims[1];
+    PyArrayObject* array;
+
+    if(!PyArg_ParseTuple(args, "i", &lmax))
+        return NULL;
+
+    if(lmax < 0)
+        return PyErr_Format(PyExc_ValueError, "requires lmax >= 0");
+
+    dims[0] = (npy_intp)wigner_3j000_size(lmax);
+    array = (PyArrayObject*)PyArray_SimpleNew(1, dims, NPY_DOUBLE);
+    if(!array)
+        return NULL;
+
+    ier = wigner_3j000_fill(lmax, PyArray_DATA(array), NULL);
+    if(ier)
+    {
+        Py_DECREF(array);
+        return PyErr_NoMemory();
+    }
+
+    return PyArray_Return(array);
+}
+
+
+static PyObject* _wigner_3j000_binned(PyObject* self, PyObject* args)
+{
+    int i, nbins, lmax, ier;
+    npy_intp dims[3];
+    PyObject* edges_obj;
+    PyObject* w_obj[3] = { Py_None, Py_None, Py_None };
+    PyArrayObject* edges;
+    PyArrayObject* w[3] = { NULL, NULL, NULL };
+    PyArrayObject* array = NULL;
+
+    if(!PyArg_ParseTuple(args, "O|OOO", &edges_obj, &w_obj[0], &w_obj[1],
+                         &w_obj[2]))
+        return NULL;
+
+    edges = int_array(edges_obj, "edges");
+    if(!edges)
+        return NULL;
+
+    nbins = (int)PyArray_DIM(edges, 0) - 1;
+    if(nbins < 1)
+    {
+        PyErr_Format(PyExc_ValueError, "requires at least two bin edges");
+        goto done;
+    }
+    lmax = ((int*)PyArray_DATA(edges))[nbins] - 1;
+
+    for(i = 0; i < 3; ++i)
+    {
+        if(w_obj[i] == Py_None)
+            continue;
+        w[i] = (PyArrayObject*)PyArray_FROMANY(w_obj[i], NPY_DOUBLE, 1, 1,
+                                               NPY_ARRAY_IN_ARRAY);
+        if(!w[i])
+            goto done;
+        if(PyArray_DIM(w[i], 0) <= lmax)
+        {
+            PyErr_Format(PyExc_ValueError, "weights must have size > %d",
+                         lmax);
+            goto done;
+        }
+    }
+
+    dims[0] = dims[1] = dims[2] = nbins;
+    array = (PyArrayObject*)PyArray_ZEROS(3, dims, NPY_DOUBLE, 0);
+    if(!array)
+        goto done;
+
+    ier = wigner_3j000_binned(nbins, PyArray_DATA(edges),
+                              w[0] ? PyArray_DATA(w[0]) : NULL,
+                              w[1] ? PyArray_DATA(w[1]) : NULL,
+                              w[2] ? PyArray_DATA(w[2]) : NULL,
+                              PyArray_DATA(array), NULL);
+    if(ier == 1)
+    {
+        Py_CLEAR(array);
+        PyErr_NoMemory();
+    }
+    else if(ier)
+    {
+        Py_CLEAR(array);
+        PyErr_Format(PyExc_ValueError,
+                     "bin edges must be non-negative and increasing");
+    }
+
+done:
+    Py_DECREF(edges);
+    for(i = 0; i < 3; ++i)
+        Py_XDECREF(w[i]);
+
+    return (PyObject*)array;
+}
+
+
+static PyObject* _wigner_3j000_index(PyObject* self, PyObject* args)
+{
+    int l1, l2, l3;
+
+    if(!PyArg_ParseTuple(args, "iii", &l1, &l2, &l3))
+        return NULL;
+
+    if(l1 < 0 || l1 > l2 || l2 > l3 || l3 > l1+l2 || (l1+l2+l3) % 2)
+        return PyErr_Format(PyExc_ValueError, "requires l1 <= l2 <= l3 <= l1+l2 with even l1+l2+l3");
+
+    return PyLong_FromSize_t(wigner_3j000_index(l1, l2, l3));
+}
+
+
+static PyObject* _clebsch_gordan_block(PyObject* self, PyObject* args)
+{
+    int l1, l2, l3;
+    npy_intp dims[2];
+    PyArrayObject* array;
+
+    if(!PyArg_ParseTuple(args, "iii", &l1, &l2, &l3))
+        return NULL;
+
+    if((l1+l2-l3 < 0) || (l1-l2+l3 < 0) || (-l1+l2+l3 < 0))
+        return PyErr_Format(PyExc_ValueError, "`abs(l1-l2) <= l3 <= l1+l2` not satisfied");
+
+    dims[0] = 2*l1+1;
+    dims[1] = 2*l2+1;
+    array = (PyArrayObject*)PyArray_SimpleNew(2, dims, NPY_DOUBLE);
+    if(!array)
+        return NULL;
+
+    clebsch_gordan_block(l1, l2, l3, PyArray_DATA(array));
+
+    return PyArray_Return(array);
+}
+
+
+static PyObject* _wigner_3j_single(PyObject* self, PyObject* args)
+{
+    double l1, l2, l3, m1, m2, m3;
+
+    if(!PyArg_ParseTuple(args, "dddddd", &l1, &l2, &l3, &m1, &m2, &m3))
+        return NULL;
+
+    return PyFloat_FromDouble(wigner_3j_single(l1, l2, l3, m1, m2, m3));
+}
+
+
+static PyObject* _wigner_6j_single(PyObject* self, PyObject* args)
+{
+    double l1, l2, l3, l4, l5, l6;
+
+    if(!PyArg_ParseTuple(args, "dddddd", &l1, &l2, &l3, &l4, &l5, &l6))
+        return NULL;
+
+    return PyFloat_FromDouble(wigner_6j_single(l1, l2, l3, l4, l5, l6));
+}
+
+
 static PyObject* _wigner_6j(PyObject* self, PyObject* args)
 {
     double l2, l3, l4, l5, l6, l1min, l1max;
@@ -190,6 +412,546 @@ static PyObject* _wigner_dl(PyObject* self, PyObject* args)
 }
 
 
+static PyObject* _wigner_dl_multi(PyObject* self, PyObject* args)
+{
+    int lmin, lmax, nspin, interleave = 0;
+    double theta;
+    npy_intp dims[2];
+    PyObject* m1_obj;
+    PyObject* m2_obj;
+    PyArrayObject* m1;
+    PyArrayObject* m2;
+    PyArrayObject* array;
+
+    if(!PyArg_ParseTuple(args, "iiOOd|p", &lmin, &lmax, &m1_obj, &m2_obj,
+                         &theta, &interleave))
+        return NULL;
+
+    if(lmin < 0 || lmax < lmin)
+        return PyErr_Format(PyExc_ValueError, "requires 0 <= lmin <= lmax");
+
+    m1 = int_array(m1_obj, "m1");
+    if(!m1)
+        return NULL;
+    m2 = int_array(m2_obj, "m2");
+    if(!m2)
+    {
+        Py_DECREF(m1);
+        return NULL;
+    }
+
+    nspin = PyArray_DIM(m1, 0);
+    if(PyArray_DIM(m2, 0) != nspin)
+    {
+        Py_DECREF(m1);
+        Py_DECREF(m2);
+        return PyErr_Format(PyExc_ValueError,
+                            "m1 and m2 must have the same size");
+    }
+
+    if(interleave)
+        dims[0] = lmax-lmin+1, dims[1] = nspin;
+    else
+        dims[0] = nspin, dims[1] = lmax-lmin+1;
+    array = (PyArrayObject*)PyArray_SimpleNew(2, dims, NPY_DOUBLE);
+    if(array)
+        wigner_dl_multi(lmin, lmax, nspin, PyArray_DATA(m1), PyArray_DATA(m2),
+                        theta, interleave, PyArray_DATA(array));
+
+    Py_DECREF(m1);
+    Py_DECREF(m2);
+
+    return (PyObject*)array;
+}
+
+
+static PyObject* _legendre_pl_deriv(PyObject* self, PyObject* args)
+{
+    int lmin, lmax, n;
+    double x;
+    npy_intp dims[1];
+    PyArrayObject* p;
+    PyArrayObject* dp;
+
+    if(!PyArg_ParseTuple(args, "iid", &lmin, &lmax, &x))
+        return NULL;
+
+    if(lmin < 0 || lmax < lmin)
+        return PyErr_Format(PyExc_ValueError, "requires 0 <= lmin <= lmax");
+
+    n = lmax-lmin+1;
+    dims[0] = n;
+    p = (PyArrayObject*)PyArray_SimpleNew(1, dims, NPY_DOUBLE);
+    if(!p)
+        return NULL;
+    dp = (PyArrayObject*)PyArray_SimpleNew(1, dims, NPY_DOUBLE);
+    if(!dp)
+    {
+        Py_DECREF(p);
+        return NULL;
+    }
+
+    legendre_pl_deriv(lmin, lmax, x, PyArray_DATA(p), PyArray_DATA(dp));
+
+    return Py_BuildValue("NN", PyArray_Return(p), PyArray_Return(dp));
+}
+
+
+static PyObject* _wigner_dl_deriv(PyObject* self, PyObject* args)
+{
+    int lmin, lmax, m1, m2, n;
+    double theta;
+    npy_intp dims[1];
+    PyArrayObject* d;
+    PyArrayObject* dd;
+
+    if(!PyArg_ParseTuple(args, "iiiid", &lmin, &lmax, &m1, &m2, &theta))
+        return NULL;
+
+    if(lmin < 0 || lmax < lmin)
+        return PyErr_Format(PyExc_ValueError, "requires 0 <= lmin <= lmax");
+
+    n = lmax-lmin+1;
+    dims[0] = n;
+    d = (PyArrayObject*)PyArray_SimpleNew(1, dims, NPY_DOUBLE);
+    if(!d)
+        return NULL;
+    dd = (PyArrayObject*)PyArray_SimpleNew(1, dims, NPY_DOUBLE);
+    if(!dd)
+    {
+        Py_DECREF(d);
+        return NULL;
+    }
+
+    wigner_dl_deriv(lmin, lmax, m1, m2, theta, PyArray_DATA(d),
+                    PyArray_DATA(dd));
+
+    return Py_BuildValue("NN", PyArray_Return(d), PyArray_Return(dd));
+}
+
+
+static PyObject* _legendre_pl_binavg(PyObject* self, PyObject* args)
+{
+    int lmin, lmax, n;
+    double xa, xb;
+    double* p;
+    npy_intp dims[1];
+    PyArrayObject* array;
+
+    if(!PyArg_ParseTuple(args, "iidd", &lmin, &lmax, &xa, &xb))
+        return NULL;
+
+    if(lmin < 0 || lmax < lmin)
+        return PyErr_Format(PyExc_ValueError, "requires 0 <= lmin <= lmax");
+
+    n = lmax-lmin+1;
+    dims[0] = n;
+    array = (PyArrayObject*)PyArray_SimpleNew(1, dims, NPY_DOUBLE);
+    if(!array)
+        return NULL;
+    p = PyArray_DATA(array);
+
+    legendre_pl_binavg(lmin, lmax, xa, xb, p);
+
+    return PyArray_Return(array);
+}
+
+
+static int plm_norm(const char* norm_str, int* norm)
+{
+    if(strcmp(norm_str, "ortho") == 0)
+        *norm = LEGENDRE_PLM_ORTHO;
+    else if(strcmp(norm_str, "schmidt") == 0)
+        *norm = LEGENDRE_PLM_SCHMIDT;
+    else if(strcmp(norm_str, "unnorm") == 0)
+        *norm = LEGENDRE_PLM_UNNORM;
+    else
+    {
+        PyErr_Format(PyExc_ValueError,
+                     "norm must be \"ortho\", \"schmidt\", or \"unnorm\"");
+        return 0;
+    }
+    return 1;
+}
+
+
+static PyObject* _legendre_plm(PyObject* self, PyObject* args)
+{
+    int lmax, m, norm, n, ier;
+    const char* norm_str = "ortho";
+    npy_intp dims[2];
+    PyObject* x_obj;
+    PyArrayObject* x;
+    PyArrayObject* array;
+
+    if(!PyArg_ParseTuple(args, "iiO|s", &lmax, &m, &x_obj, &norm_str))
+        return NULL;
+
+    if(!plm_norm(norm_str, &norm))
+        return NULL;
+
+    if(m < 0 || lmax < m)
+        return PyErr_Format(PyExc_ValueError, "requires 0 <= m <= lmax");
+
+    x = (PyArrayObject*)PyArray_FROMANY(x_obj, NPY_DOUBLE, 1, 1,
+                                        NPY_ARRAY_IN_ARRAY);
+    if(!x)
+        return NULL;
+
+    n = (int)PyArray_DIM(x, 0);
+    dims[0] = n;
+    dims[1] = lmax-m+1;
+    array = (PyArrayObject*)PyArray_SimpleNew(2, dims, NPY_DOUBLE);
+    if(array)
+    {
+        ier = legendre_plm(lmax, m, norm, n, PyArray_DATA(x),
+                           PyArray_DATA(array), NULL);
+        if(ier)
+        {
+            Py_CLEAR(array);
+            PyErr_NoMemory();
+        }
+    }
+
+    Py_DECREF(x);
+
+    return (PyObject*)array;
+}
+
+
+static PyObject* _legendre_plm_all(PyObject* self, PyObject* args)
+{
+    int lmax, norm, n, ier;
+    const char* norm_str = "ortho";
+    npy_intp dims[2];
+    PyObject* x_obj;
+    PyArrayObject* x;
+    PyArrayObject* array;
+
+    if(!PyArg_ParseTuple(args, "iO|s", &lmax, &x_obj, &norm_str))
+        return NULL;
+
+    if(!plm_norm(norm_str, &norm))
+        return NULL;
+
+    if(lmax < 0)
+        return PyErr_Format(PyExc_ValueError, "requires lmax >= 0");
+
+    x = (PyArrayObject*)PyArray_FROMANY(x_obj, NPY_DOUBLE, 1, 1,
+                                        NPY_ARRAY_IN_ARRAY);
+    if(!x)
+        return NULL;
+
+    n = (int)PyArray_DIM(x, 0);
+    dims[0] = n;
+    dims[1] = wigner_alm_size(WIGNER_ALM_HEALPIX, lmax);
+    array = (PyArrayObject*)PyArray_SimpleNew(2, dims, NPY_DOUBLE);
+    if(array)
+    {
+        ier = legendre_plm_all(lmax, norm, n, PyArray_DATA(x),
+                               PyArray_DATA(array), NULL);
+        if(ier)
+        {
+            Py_CLEAR(array);
+            PyErr_NoMemory();
+        }
+    }
+
+    Py_DECREF(x);
+
+    return (PyObject*)array;
+}
+
+
+static PyObject* _wigner_dl_binavg(PyObject* self, PyObject* args)
+{
+    int lmin, lmax, m1, m2, n;
+    double theta_a, theta_b;
+    double* d;
+    npy_intp dims[1];
+    PyArrayObject* array;
+
+    if(!PyArg_ParseTuple(args, "iiiidd", &lmin, &lmax, &m1, &m2, &theta_a,
+                         &theta_b))
+        return NULL;
+
+    if(lmin < 0 || lmax < lmin)
+        return PyErr_Format(PyExc_ValueError, "requires 0 <= lmin <= lmax");
+
+    n = lmax-lmin+1;
+    dims[0] = n;
+    array = (PyArrayObject*)PyArray_SimpleNew(1, dims, NPY_DOUBLE);
+    if(!array)
+        return NULL;
+    d = PyArray_DATA(array);
+
+    if(wigner_dl_binavg(lmin, lmax, m1, m2, theta_a, theta_b, d))
+    {
+        Py_DECREF(array);
+        return PyErr_NoMemory();
+    }
+
+    return PyArray_Return(array);
+}
+
+
+static PyObject* _spin_ylm(PyObject* self, PyObject* args)
+{
+    int s, lmax, order, n, ier;
+    const char* order_str = "healpix";
+    npy_intp dims[2];
+    PyObject* theta_obj;
+    PyObject* phi_obj;
+    PyArrayObject* theta;
+    PyArrayObject* phi = NULL;
+    PyArrayObject* array = NULL;
+
+    if(!PyArg_ParseTuple(args, "iiOO|s", &s, &lmax, &theta_obj, &phi_obj,
+                         &order_str))
+        return NULL;
+
+    if(strcmp(order_str, "healpix") == 0)
+        order = WIGNER_ALM_HEALPIX;
+    else if(strcmp(order_str, "lm") == 0)
+        order = WIGNER_ALM_LM;
+    else
+        return PyErr_Format(PyExc_ValueError,
+                            "order must be \"healpix\" or \"lm\"");
+
+    if(lmax < 0)
+        return PyErr_Format(PyExc_ValueError, "requires lmax >= 0");
+
+    theta = (PyArrayObject*)PyArray_FROMANY(theta_obj, NPY_DOUBLE, 1, 1,
+                                            NPY_ARRAY_IN_ARRAY);
+    if(!theta)
+        return NULL;
+    phi = (PyArrayObject*)PyArray_FROMANY(phi_obj, NPY_DOUBLE, 1, 1,
+                                          NPY_ARRAY_IN_ARRAY);
+    if(!phi)
+        goto done;
+
+    n = (int)PyArray_DIM(theta, 0);
+    if(PyArray_DIM(phi, 0) != n)
+    {
+        PyErr_Format(PyExc_ValueError, "theta and phi must have equal size");
+        goto done;
+    }
+
+    dims[0] = n;
+    dims[1] = wigner_alm_size(order, lmax);
+    array = (PyArrayObject*)PyArray_SimpleNew(2, dims, NPY_CDOUBLE);
+    if(!array)
+        goto done;
+
+    ier = spin_ylm(s, lmax, order, n, PyArray_DATA(theta), PyArray_DATA(phi),
+                   PyArray_DATA(array), NULL);
+    if(ier)
+    {
+        Py_CLEAR(array);
+        PyErr_NoMemory();
+    }
+
+done:
+    Py_DECREF(theta);
+    Py_XDECREF(phi);
+
+    return (PyObject*)array;
+}
+
+static PyObject* _spin_synth(PyObject* self, PyObject* args)
+{
+    int s, lmax, order, n, ier;
+    const char* order_str = "healpix";
+    npy_intp dims[1];
+    PyObject* alm_obj;
+    PyObject* theta_obj;
+    PyObject* phi_obj;
+    PyArrayObject* alm;
+    PyArrayObject* theta = NULL;
+    PyArrayObject* phi = NULL;
+    PyArrayObject* array = NULL;
+
+    if(!PyArg_ParseTuple(args, "iiOOO|s", &s, &lmax, &alm_obj, &theta_obj,
+                         &phi_obj, &order_str))
+        return NULL;
+
+    if(strcmp(order_str, "healpix") == 0)
+        order = WIGNER_ALM_HEALPIX;
+    else if(strcmp(order_str, "lm") == 0)
+        order = WIGNER_ALM_LM;
+    else
+        return PyErr_Format(PyExc_ValueError,
+                            "order must be \"healpix\" or \"lm\"");
+
+    if(lmax < 0)
+        return PyErr_Format(PyExc_ValueError, "requires lmax >= 0");
+
+    alm = (PyArrayObject*)PyArray_FROMANY(alm_obj, NPY_CDOUBLE, 1, 1,
+                                          NPY_ARRAY_IN_ARRAY);
+    if(!alm)
+        return NULL;
+    if((size_t)PyArray_DIM(alm, 0) != wigner_alm_size(order, lmax))
+    {
+        PyErr_Format(PyExc_ValueError, "alm must have size %zu",
+                     wigner_alm_size(order, lmax));
+        goto done;
+    }
+
+    theta = (PyArrayObject*)PyArray_FROMANY(theta_obj, NPY_DOUBLE, 1, 1,
+                                            NPY_ARRAY_IN_ARRAY);
+    if(!theta)
+        goto done;
+    phi = (PyArrayObject*)PyArray_FROMANY(phi_obj, NPY_DOUBLE, 1, 1,
+                                          NPY_ARRAY_IN_ARRAY);
+    if(!phi)
+        goto done;
+
+    n = (int)PyArray_DIM(theta, 0);
+    if(PyArray_DIM(phi, 0) != n)
+    {
+        PyErr_Format(PyExc_ValueError, "theta and phi must have equal size");
+        goto done;
+    }
+
+    dims[0] = n;
+    array = (PyArrayObject*)PyArray_SimpleNew(1, dims, NPY_CDOUBLE);
+    if(!array)
+        goto done;
+
+    ier = spin_synth(s, lmax, order, PyArray_DATA(alm), n,
+                     PyArray_DATA(theta), PyArray_DATA(phi),
+                     PyArray_DATA(array), NULL);
+    if(ier)
+    {
+        Py_CLEAR(array);
+        PyErr_NoMemory();
+    }
+
+done:
+    Py_DECREF(alm);
+    Py_XDECREF(theta);
+    Py_XDECREF(phi);
+
+    return (PyObject*)array;
+}
+
+static PyObject* _rotate_alm(PyObject* self, PyObject* args)
+{
+    int lmax, order, ier;
+    double alpha, beta, gamma;
+    const char* order_str = "healpix";
+    PyObject* alm_obj;
+    PyArrayObject* array;
+
+    if(!PyArg_ParseTuple(args, "idddO|s", &lmax, &alpha, &beta, &gamma,
+                         &alm_obj, &order_str))
+        return NULL;
+
+    if(strcmp(order_str, "healpix") == 0)
+        order = WIGNER_ALM_HEALPIX;
+    else if(strcmp(order_str, "lm") == 0)
+        order = WIGNER_ALM_LM;
+    else
+        return PyErr_Format(PyExc_ValueError,
+                            "order must be \"healpix\" or \"lm\"");
+
+    if(lmax < 0)
+        return PyErr_Format(PyExc_ValueError, "requires lmax >= 0");
+
+    array = (PyArrayObject*)PyArray_FROMANY(alm_obj, NPY_CDOUBLE, 1, 1,
+                                            NPY_ARRAY_IN_ARRAY
+                                            | NPY_ARRAY_ENSURECOPY);
+    if(!array)
+        return NULL;
+    if((size_t)PyArray_DIM(array, 0) != wigner_alm_size(order, lmax))
+    {
+        Py_DECREF(array);
+        return PyErr_Format(PyExc_ValueError, "alm must have size %zu",
+                            wigner_alm_size(order, lmax));
+    }
+
+    ier = rotate_alm(lmax, order, alpha, beta, gamma, PyArray_DATA(array),
+                     NULL);
+    if(ier)
+    {
+        Py_DECREF(array);
+        return PyErr_NoMemory();
+    }
+
+    return (PyObject*)array;
+}
+
+static PyObject* _gauss_legendre(PyObject* self, PyObject* args)
+{
+    int n;
+    npy_intp dims[1];
+    PyArrayObject* x;
+    PyArrayObject* w;
+
+    if(!PyArg_ParseTuple(args, "i", &n))
+        return NULL;
+
+    if(n < 1)
+        return PyErr_Format(PyExc_ValueError, "requires n >= 1");
+
+    dims[0] = n;
+    x = (PyArrayObject*)PyArray_SimpleNew(1, dims, NPY_DOUBLE);
+    if(!x)
+        return NULL;
+    w = (PyArrayObject*)PyArray_SimpleNew(1, dims, NPY_DOUBLE);
+    if(!w)
+    {
+        Py_DECREF(x);
+        return NULL;
+    }
+
+    gauss_legendre(n, PyArray_DATA(x), PyArray_DATA(w));
+
+    return Py_BuildValue("NN", PyArray_Return(x), PyArray_Return(w));
+}
+
+
+static PyObject* _wigner_stats(PyObject* self, PyObject* args)
+{
+    const char* name;
+    int routine;
+    struct wigner_stats stats;
+
+    if(!PyArg_ParseTuple(args, "s", &name))
+        return NULL;
+
+    if(strcmp(name, "3jj") == 0)
+        routine = WIGNER_STATS_3JJ;
+    else if(strcmp(name, "3jm") == 0)
+        routine = WIGNER_STATS_3JM;
+    else if(strcmp(name, "6j") == 0)
+        routine = WIGNER_STATS_6J;
+    else
+        return PyErr_Format(PyExc_ValueError,
+                            "routine must be one of '3jj', '3jm', '6j'");
+
+    if(wigner_stats_get(routine, &stats))
+        return PyErr_Format(PyExc_RuntimeError,
+                            "module was built without WIGNER_STATS");
+
+    return Py_BuildValue("{sLsLsLsLsLsLsL}",
+                         "calls", stats.calls,
+                         "coefs", stats.coefs,
+                         "rescales", stats.rescales,
+                         "fwd_steps", stats.fwd_steps,
+                         "bwd_steps", stats.bwd_steps,
+                         "nobac", stats.nobac,
+                         "zeroed", stats.zeroed);
+}
+
+
+static PyObject* _wigner_stats_reset(PyObject* self, PyObject* args)
+{
+    wigner_stats_reset();
+    Py_RETURN_NONE;
+}
+
+
 static PyMethodDef methods[] = {
     {"legendre_pl", _legendre_pl, METH_VARARGS, PyDoc_STR(
         "legendre_pl(lmin, lmax, x)\n"
@@ -261,6 +1023,221 @@ static PyMethodDef methods[] = {
         "and the angle `theta` must be given in radian as float.  Returns a\n"
         "numpy array of size `lmax-lmin+1`.\n"
     )},
+    {"wigner_dl_multi", _wigner_dl_multi, METH_VARARGS, PyDoc_STR(
+        "wigner_dl_multi(lmin, lmax, m1, m2, theta, interleave=False)\n"
+        "--\n"
+        "\n"
+        "Compute the Wigner d functions for the pairs of spins in the\n"
+        "sequences `m1` and `m2` in a single pass.  Returns a numpy array of\n"
+        "shape `(len(m1), lmax-lmin+1)`, or `(lmax-lmin+1, len(m1))` if\n"
+        "`interleave` is true.\n"
+    )},
+    {"legendre_pl_deriv", _legendre_pl_deriv, METH_VARARGS, PyDoc_STR(
+        "legendre_pl_deriv(lmin, lmax, x)\n"
+        "--\n"
+        "\n"
+        "Compute the Legendre polynomials `P_l(x)` and their derivatives\n"
+        "`dP_l/dx` for all degrees `l = lmin` to `l = lmax`, with `x` being\n"
+        "held fixed.  The arguments `lmin` and `lmax` must be integers, while\n"
+        "the argument `x` must be float.  Returns a tuple `p, dp` of numpy\n"
+        "arrays of size `lmax-lmin+1`.\n"
+    )},
+    {"wigner_dl_deriv", _wigner_dl_deriv, METH_VARARGS, PyDoc_STR(
+        "wigner_dl_deriv(lmin, lmax, m1, m2, theta)\n"
+        "--\n"
+        "\n"
+        "Compute the Wigner d function `d^l_{m1,m2}(theta)` and its derivative\n"
+        "with respect to `theta` for all degrees `l = lmin` to `l = lmax`,\n"
+        "with `m1`, `m2`, and `theta` being held fixed.  The arguments `lmin`,\n"
+        "`lmax`, `m1`, `m2` must be integers, and the angle `theta` must be\n"
+        "given in radian as float.  Returns a tuple `d, dd` of numpy arrays of\n"
+        "size `lmax-lmin+1`.\n"
+    )},
+    {"legendre_pl_binavg", _legendre_pl_binavg, METH_VARARGS, PyDoc_STR(
+        "legendre_pl_binavg(lmin, lmax, xa, xb)\n"
+        "--\n"
+        "\n"
+        "Compute the averages of the Legendre polynomials `P_l(x)` over the\n"
+        "interval `[xa, xb]` for all degrees `l = lmin` to `l = lmax`.  The\n"
+        "arguments `lmin` and `lmax` must be integers, while the arguments\n"
+        "`xa` and `xb` must be float.  Returns a numpy array of size\n"
+        "`lmax-lmin+1`.\n"
+    )},
+    {"legendre_plm", _legendre_plm, METH_VARARGS, PyDoc_STR(
+        "legendre_plm(lmax, m, x, norm=\"ortho\")\n"
+        "--\n"
+        "\n"
+        "Compute the associated Legendre functions `P_lm(x)` of order `m` for\n"
+        "all degrees `l = m` to `l = lmax` at the arguments `x`, given as a\n"
+        "numpy array of size `n`.  The normalisation `norm` is \"ortho\" for\n"
+        "the functions of the spherical harmonics `Y_lm(theta, 0)`, with the\n"
+        "Condon-Shortley phase, \"schmidt\" for the Schmidt semi-normalised\n"
+        "functions without the phase, or \"unnorm\" for the unnormalised\n"
+        "functions with the phase, which overflow for large `m`.  Returns a\n"
+        "numpy array of shape `(n, lmax-m+1)`.\n"
+    )},
+    {"legendre_plm_all", _legendre_plm_all, METH_VARARGS, PyDoc_STR(
+        "legendre_plm_all(lmax, x, norm=\"ortho\")\n"
+        "--\n"
+        "\n"
+        "Compute the associated Legendre functions of `legendre_plm` for all\n"
+        "orders `m = 0` to `m = lmax` at once.  Returns a numpy array of\n"
+        "shape `(n, nalm)`, with the modes in the default ordering of\n"
+        "`spin_ylm`.\n"
+    )},
+    {"wigner_dl_binavg", _wigner_dl_binavg, METH_VARARGS, PyDoc_STR(
+        "wigner_dl_binavg(lmin, lmax, m1, m2, theta_a, theta_b)\n"
+        "--\n"
+        "\n"
+        "Compute the averages of the Wigner d functions `d^l_{m1,m2}(theta)`\n"
+        "over the angular bin `[theta_a, theta_b]` for all degrees `l = lmin`\n"
+        "to `l = lmax`, with `m1` and `m2` being held fixed.  The average is\n"
+        "taken over the solid angle of the bin, i.e. uniformly in\n"
+        "`cos(theta)`.  The arguments `lmin`, `lmax`, `m1`, `m2` must be\n"
+        "integers, and the angles `theta_a`, `theta_b` must be given in\n"
+        "radian as float.  Returns a numpy array of size `lmax-lmin+1`.\n"
+    )},
+    {"rotate_alm", _rotate_alm, METH_VARARGS, PyDoc_STR(
+        "rotate_alm(lmax, alpha, beta, gamma, alm, order=\"healpix\")\n"
+        "--\n"
+        "\n"
+        "Rotate the spherical harmonic coefficients `alm` up to `lmax`, given\n"
+        "as a complex numpy array in the ordering `order` of `spin_ylm`, by\n"
+        "the Euler angles `alpha, beta, gamma` in radian, in the zyz\n"
+        "convention.  The coefficients are multiplied by the Wigner D-matrix\n"
+        "`D^l_{m,m'} = exp(-i m alpha) d^l_{m,m'}(beta) exp(-i m' gamma)`,\n"
+        "which is never stored.  In the default ordering, the coefficients\n"
+        "are those of a real field.  Returns a new complex numpy array.\n"
+    )},
+    {"spin_synth", _spin_synth, METH_VARARGS, PyDoc_STR(
+        "spin_synth(s, lmax, alm, theta, phi, order=\"healpix\")\n"
+        "--\n"
+        "\n"
+        "Compute the sums `f = sum alm[l, m] sY_lm(theta, phi)` of the spin-\n"
+        "weighted spherical harmonics of `spin_ylm` for all modes up to\n"
+        "`lmax` in the complex numpy array `alm`, ordered as in `spin_ylm`,\n"
+        "at the points `theta, phi`, given in radian as numpy arrays of equal\n"
+        "size `n`.  The harmonics are not stored, so that the memory does not\n"
+        "grow with the number of points.  In the default ordering, the sum\n"
+        "includes the modes with `m < 0`, with `a_{l,-m} = (-1)^m a_lm^*` as\n"
+        "in `rotate_alm`, and the imaginary parts of `a_l0` are ignored, so\n"
+        "that the result for `s = 0` is the real field of the coefficients.\n"
+        "Returns a complex numpy array of size `n`.\n"
+    )},
+    {"spin_ylm", _spin_ylm, METH_VARARGS, PyDoc_STR(
+        "spin_ylm(s, lmax, theta, phi, order=\"healpix\")\n"
+        "--\n"
+        "\n"
+        "Compute the spin-weighted spherical harmonics `sY_lm(theta, phi)` of\n"
+        "spin `s` for all degrees up to `lmax` at the points `theta, phi`,\n"
+        "given in radian as numpy arrays of equal size `n`.  The harmonics\n"
+        "are `(-1)^s sqrt((2l+1)/(4 pi)) d^l_{m,-s}(theta) exp(i m phi)`,\n"
+        "which have the Condon-Shortley phase for `s = 0`.  Returns a complex\n"
+        "numpy array of shape `(n, nalm)`, in which the modes are ordered as\n"
+        "in HEALPix with `m >= 0` only at index `m*(2*lmax+1-m)//2 + l`, or\n"
+        "for `order=\"lm\"` with all `m` at index `l*(l+1) + m`.\n"
+    )},
+    {"wigner_3j_block", _wigner_3j_block, METH_VARARGS, PyDoc_STR(
+        "wigner_3j_block(l1, l2, l3)\n"
+        "--\n"
+        "\n"
+        "Evaluate the Wigner 3j symbol\n"
+        "\n"
+        "    / l1  l2    l3  \\\n"
+        "    \\ m1  m2  -m1-m2/\n"
+        "\n"
+        "for all values of `m1` and `m2`, with integer `l1`, `l2`, `l3` held\n"
+        "fixed.  Returns a numpy array of shape `(2*l1+1, 2*l2+1)` where the\n"
+        "entry `[l1+m1, l2+m2]` contains the 3j symbol, which is zero if\n"
+        "`abs(m1+m2) > l3`.\n"
+    )},
+    {"wigner_3j000", _wigner_3j000, METH_VARARGS, PyDoc_STR(
+        "wigner_3j000(lmax)\n"
+        "--\n"
+        "\n"
+        "Compute the Wigner 3j symbols `(l1 l2 l3; 0 0 0)` for all degrees up\n"
+        "to `lmax` as a packed tensor.  Only the symbols with `l1 <= l2 <=\n"
+        "l3 <= l1+l2` and even `l1+l2+l3` are stored, since all others are\n"
+        "zero or follow by permutation.  Returns a numpy array, in which the\n"
+        "symbol for `l1, l2, l3` is at `wigner_3j000_index(l1, l2, l3)`.\n"
+    )},
+    {"wigner_3j000_binned", _wigner_3j000_binned, METH_VARARGS, PyDoc_STR(
+        "wigner_3j000_binned(edges, w1=None, w2=None, w3=None)\n"
+        "--\n"
+        "\n"
+        "Compute the binned sums of `w1[l1] w2[l2] w3[l3] (l1 l2 l3; 0 0 0)^2`\n"
+        "over all degrees in the bins `edges[i] <= l < edges[i+1]`, without\n"
+        "storing any 3j symbols.  The weights are numpy arrays indexed by\n"
+        "`l`, or one if `None`.  Returns a numpy array of shape `(nbins,\n"
+        "nbins, nbins)` with the sums for the bins of `l1, l2, l3`.\n"
+    )},
+    {"wigner_3j000_index", _wigner_3j000_index, METH_VARARGS, PyDoc_STR(
+        "wigner_3j000_index(l1, l2, l3)\n"
+        "--\n"
+        "\n"
+        "Return the index of the symbol `(l1 l2 l3; 0 0 0)` in the packed\n"
+        "tensor of `wigner_3j000`.  The degrees must satisfy `l1 <= l2 <= l3\n"
+        "<= l1+l2` with even `l1+l2+l3`, otherwise a `ValueError` is raised.\n"
+    )},
+    {"clebsch_gordan_block", _clebsch_gordan_block, METH_VARARGS, PyDoc_STR(
+        "clebsch_gordan_block(l1, l2, l3)\n"
+        "--\n"
+        "\n"
+        "Compute the Clebsch-Gordan coefficients `<l1 m1 l2 m2|l3 m1+m2>` for\n"
+        "all values of `m1` and `m2`, with integer `l1`, `l2`, `l3` held\n"
+        "fixed.  Returns a numpy array of shape `(2*l1+1, 2*l2+1)` where the\n"
+        "entry `[l1+m1, l2+m2]` contains the coefficient, which is zero if\n"
+        "`abs(m1+m2) > l3`.\n"
+    )},
+    {"wigner_3j_single", _wigner_3j_single, METH_VARARGS, PyDoc_STR(
+        "wigner_3j_single(l1, l2, l3, m1, m2, m3)\n"
+        "--\n"
+        "\n"
+        "Evaluate the single Wigner 3j symbol\n"
+        "\n"
+        "    / l1  l2  l3 \\\n"
+        "    \\ m1  m2  m3 /\n"
+        "\n"
+        "The arguments must be integer or half-integer.  Returns zero if the\n"
+        "selection rules are not satisfied.\n"
+    )},
+    {"wigner_6j_single", _wigner_6j_single, METH_VARARGS, PyDoc_STR(
+        "wigner_6j_single(l1, l2, l3, l4, l5, l6)\n"
+        "--\n"
+        "\n"
+        "Evaluate the single Wigner 6j symbol\n"
+        "\n"
+        "    {l1  l2  l3}\n"
+        "    {l4  l5  l6}\n"
+        "\n"
+        "The arguments must be integer or half-integer.  Returns zero if the\n"
+        "triangle conditions are not satisfied.\n"
+    )},
+    {"gauss_legendre", _gauss_legendre, METH_VARARGS, PyDoc_STR(
+        "gauss_legendre(n)\n"
+        "--\n"
+        "\n"
+        "Compute the nodes and weights of the `n`-point Gauss-Legendre\n"
+        "quadrature on the interval `[-1, 1]`.  The argument `n` must be a\n"
+        "positive integer.  Returns a tuple `x, w` of numpy arrays of size\n"
+        "`n`, where the nodes `x` are in ascending order.\n"
+    )},
+    {"wigner_stats", _wigner_stats, METH_VARARGS, PyDoc_STR(
+        "wigner_stats(routine)\n"
+        "--\n"
+        "\n"
+        "Return the instrumentation counters of the recursion `routine`,\n"
+        "which is one of `'3jj'`, `'3jm'`, `'6j'`, as a dict.  Counters are\n"
+        "collected per thread, including the work of parallel routines\n"
+        "called from the thread, and only if the module was built with\n"
+        "`WIGNER_STATS` defined; otherwise a `RuntimeError` is raised.\n"
+    )},
+    {"wigner_stats_reset", _wigner_stats_reset, METH_NOARGS, PyDoc_STR(
+        "wigner_stats_reset()\n"
+        "--\n"
+        "\n"
+        "Reset the instrumentation counters of the calling thread.\n"
+    )},
     {NULL, NULL}
 };
 
@@ -1,21 +1,112 @@
+import os
+import shutil
+import subprocess
 import setuptools
+import setuptools.command.build_ext
 import numpy as np
 
+
+class build_ext(setuptools.command.build_ext.build_ext):
+    """Build the extension, optionally with profile-guided optimisation.
+
+    If the environment variable WIGNER_PGO is set, the library sources are
+    first compiled with instrumentation into the training workload in
+    pgo/train.c, which is run to produce a profile, and the extension is
+    then compiled with the profile.  This requires GCC, or Clang together
+    with llvm-profdata.
+    """
+
+    def build_extension(self, ext):
+        if os.environ.get("WIGNER_PGO"):
+            ext.extra_compile_args = ext.extra_compile_args + self.pgo(ext)
+        super().build_extension(ext)
+
+    def pgo(self, ext):
+        if self.compiler.compiler_type != "unix":
+            raise RuntimeError("WIGNER_PGO requires GCC or Clang")
+
+        version = subprocess.run(self.compiler.compiler[:1] + ["--version"],
+                                 capture_output=True, text=True).stdout
+        clang = "clang" in version.lower()
+
+        pgo_dir = os.path.abspath(os.path.join(self.build_temp, "pgo"))
+        os.makedirs(pgo_dir, exist_ok=True)
+        profraw = os.path.join(pgo_dir, "wigner.profraw")
+        profdata = os.path.join(pgo_dir, "wigner.profdata")
+
+        if clang:
+            generate = ["-fprofile-instr-generate"]
+            use = ["-fprofile-instr-use=" + profdata,
+                   "-Wno-profile-instr-unprofiled"]
+        else:
+            generate = ["-fprofile-generate"]
+            use = ["-fprofile-use", "-fprofile-correction",
+                   "-Wno-missing-profile"]
+
+        # compile the library sources into the same object paths as the
+        # extension, so that GCC finds the .gcda files next to them
+        sources = [s for s in ext.sources if s.startswith("src/")]
+        objects = self.compiler.compile(
+            sources + ["pgo/train.c"],
+            output_dir=self.build_temp,
+            macros=ext.define_macros,
+            include_dirs=ext.include_dirs,
+            extra_postargs=generate,
+        )
+        train = os.path.join(pgo_dir, "wigner_pgo_train")
+        self.compiler.link_executable(objects, train, libraries=["m"],
+                                      extra_postargs=generate)
+
+        env = dict(os.environ, LLVM_PROFILE_FILE=profraw)
+        subprocess.run([train], check=True, env=env, stdout=subprocess.DEVNULL)
+
+        if clang:
+            profdata_tool = shutil.which("llvm-profdata")
+            if not profdata_tool:
+                raise RuntimeError("WIGNER_PGO requires llvm-profdata")
+            subprocess.run([profdata_tool, "merge", "-output=" + profdata,
+                            profraw], check=True)
+
+        # remove the instrumented objects so that they are rebuilt
+        for obj in objects:
+            os.remove(obj)
+
+        return use
+
+
 setuptools.setup(
+    cmdclass={
+        "build_ext": build_ext,
+    },
     ext_modules=[
         setuptools.Extension(
             "wigner",
             sources=[
                 "python/wigner.c",
+                "src/wigner_3j000.c",
+                "src/wigner_3j000_binned.c",
                 "src/wigner_3jj.c",
                 "src/wigner_3jm.c",
                 "src/wigner_6j.c",
                 "src/wigner_dl.c",
+                "src/wigner_dl_binavg.c",
+                "src/gauss_legendre.c",
+                "src/legendre_pl_tiles.c",
+                "src/legendre_plm.c",
+                "src/spin_ylm.c",
+                "src/rotate_alm.c",
+                "src/wigner_single.c",
+                "src/wigner_batch.c",
+                "src/wigner_exec.c",
+                "src/wigner_stats.c",
             ],
             include_dirs=[
                 "include",
                 np.get_include(),
             ],
+            define_macros=[
+                ("WIGNER_STATS", None),
+            ] if os.environ.get("WIGNER_STATS") else [],
         ),
     ],
 )
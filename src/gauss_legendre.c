@@ -0,0 +1,188 @@
+// compute Gauss-Legendre quadrature nodes and weights
+//
+// notes:
+// - nodes in the interior are found by Newton iteration on the asymptotic
+//   expansion of P_n(cos(theta)) from Hale & Townsend, SIAM J Sci Comput 35
+//   (2013) A652, which costs O(1) per node
+// - the few nodes near x = +-1, and all nodes for small n, use Newton
+//   iteration on the recurrence of legendre_pl
+// - the nodes are split into tasks of GL_CHUNK nodes, which run on the
+//   execution context, or with OpenMP if enabled
+
+#include <math.h>
+#include <float.h>
+
+#include "wigner.h"
+
+// smallest n for which the asymptotic expansion is used
+#ifndef GL_NASYM
+#define GL_NASYM 100
+#endif
+
+// smallest value of n*sin(theta) for which the expansion is used
+#ifndef GL_NSIN
+#define GL_NSIN 30
+#endif
+
+// maximum number of terms in the asymptotic expansion
+#ifndef GL_TERMS
+#define GL_TERMS 20
+#endif
+
+// number of nodes of each task
+#ifndef GL_CHUNK
+#define GL_CHUNK 256
+#endif
+
+// relative step size after which a single final Newton step is taken
+#define GL_TOL 1e-9
+
+#define PI 3.14159265358979323846
+
+// ratio Gamma(n+1)/Gamma(n+3/2) times sqrt(4/pi), from the asymptotic
+// expansion of log(Gamma(n+1)/Gamma(n+1/2)) for large n
+static double gl_norm(int n)
+{
+    double z = 1./n, z2 = z*z;
+    return 1.1283791670955125739*sqrt(n)/(n+0.5)
+            * exp(z*(1./8 - z2*(1./192 - z2*(1./640 - z2*(17./14336)))));
+}
+
+// asymptotic expansion of P_n(cos(theta)) and its derivative, without the
+// normalisation gl_norm(n)
+static void gl_asym(int n, double theta, double* p, double* dp)
+{
+    int m;
+    double s, c, cb, sb, h, f, r, t, ca, sa, u;
+
+    s = sin(theta);
+    c = cos(theta);
+
+    // cos and sin of alpha = (n+m+1/2)*theta - (m+1/2)*pi/2, and the
+    // rotation by theta - pi/2 from term m to term m+1
+    ca = cos((n+0.5)*theta - 0.25*PI);
+    sa = sin((n+0.5)*theta - 0.25*PI);
+    cb = s;
+    sb = -c;
+
+    h = 1;
+    f = 1/sqrt(2*s);
+    r = 1/(2*s);
+    *p = 0;
+    *dp = 0;
+    for(m = 0; m < GL_TERMS; ++m)
+    {
+        t = h*f;
+        *p += t*ca;
+        *dp -= t*((n+m+0.5)*sa + (m+0.5)*ca*c/s);
+        if(t < 0.1*DBL_EPSILON)
+            break;
+        u = ca*cb - sa*sb;
+        sa = sa*cb + ca*sb;
+        ca = u;
+        h *= (m+0.5)*(m+0.5)/((m+1)*(n+m+1.5));
+        f *= r;
+    }
+}
+
+// P_n(cos(theta)) and its derivative from the recurrence, written for the
+// differences D_l = P_l - P_{l-1} in terms of y = 1 - cos(theta), which keeps
+// full precision near theta = 0
+static void gl_rec(int n, double theta, double* p, double* dp)
+{
+    int l;
+    double s, y, d;
+
+    s = sin(0.5*theta);
+    y = 2*s*s;
+    *p = 1 - y;
+    d = -y;
+    for(l = 2; l <= n; ++l)
+    {
+        d = ((l-1)*d - (2*l-1)*y**p)/l;
+        *p += d;
+    }
+    *dp = n*(d - y**p)/sin(theta);
+}
+
+// arguments of the quadrature, shared by its tasks
+struct gl
+{
+    int n;
+    double cn;
+    double* x;
+    double* w;
+};
+
+static void gl_task(void* arg, int task)
+{
+    const struct gl* g = arg;
+    int n, k, k1, it;
+    double t, d, p, dp, xk, wk;
+
+    n = g->n;
+    k1 = (task+1)*GL_CHUNK < (n+1)/2 ? (task+1)*GL_CHUNK : (n+1)/2;
+
+    // k-th node from the top, using the symmetry of nodes and weights
+    for(k = task*GL_CHUNK+1; k <= k1; ++k)
+    {
+        t = (4*k-1)*PI/(4*n+2);
+
+        // Newton iteration for theta, where the weight is 2/P'(theta)^2
+        if(n < GL_NASYM || n*sin(t) < GL_NSIN)
+        {
+            for(it = 0; it < 100; ++it)
+            {
+                gl_rec(n, t, &p, &dp);
+                d = p/dp;
+                t -= d;
+                if(fabs(d) < GL_TOL*t)
+                    break;
+            }
+            gl_rec(n, t, &p, &dp);
+            t -= p/dp;
+            wk = 2/(dp*dp);
+        }
+        else
+        {
+            for(it = 0; it < 100; ++it)
+            {
+                gl_asym(n, t, &p, &dp);
+                d = p/dp;
+                t -= d;
+                if(fabs(d) < GL_TOL*t)
+                    break;
+            }
+            gl_asym(n, t, &p, &dp);
+            t -= p/dp;
+            wk = 2/(g->cn*g->cn*dp*dp);
+        }
+
+        xk = 2*k-1 == n ? 0 : cos(t);
+
+        g->x[n-k] = xk;
+        g->x[k-1] = -xk;
+        g->w[n-k] = g->w[k-1] = wk;
+    }
+}
+
+void gauss_legendre_exec(int n, double* x, double* w,
+                         const struct wigner_exec* exec)
+{
+    struct gl g;
+
+    if(n < 1)
+        return;
+
+    g.n = n;
+    g.cn = n < GL_NASYM ? 0 : gl_norm(n);
+    g.x = x;
+    g.w = w;
+
+    wigner_exec_run(exec, ((n+1)/2 + GL_CHUNK-1)/GL_CHUNK, gl_task, &g);
+}
+
+void gauss_legendre(int n, double* x, double* w)
+{
+    gauss_legendre_exec(n, x, w, NULL);
+}
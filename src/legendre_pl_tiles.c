@@ -0,0 +1,109 @@
+// compute Legendre polynomials on large grids of arguments and degrees in
+// tiles
+//
+// notes:
+// - the grid of n arguments x and degrees l = 0 to lmax is cut into tiles of
+//   at most xblock arguments and lblock degrees, which are handed to a
+//   callback of the caller one at a time, so that the memory does not grow
+//   with the size of the grid
+// - each block of arguments is one task, which runs the recurrence in l
+//   through its tiles in order and keeps the last two rows between them, so
+//   that nothing is computed twice
+// - the recurrence runs over the arguments of a row in the inner loop, with
+//   the same expression as legendre_pl, so that the values are identical
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "wigner.h"
+
+// arguments of the tiles, shared by their tasks
+struct tiles
+{
+    int lmax, n, xblock, lblock;
+    const double* x;
+    legendre_pl_tile* tile;
+    void* arg;
+};
+
+static int tiles_task(void* arg, int task)
+{
+    const struct tiles* t = arg;
+    int i0, ni, l0, nl, l, i;
+    const double* x;
+    const double* r1;
+    const double* r2;
+    double* buf;
+    double* c1;
+    double* c2;
+    double* row;
+
+    i0 = task*t->xblock;
+    ni = t->n - i0 < t->xblock ? t->n - i0 : t->xblock;
+    x = t->x + i0;
+
+    buf = malloc((size_t)(t->lblock+2)*ni*sizeof(double));
+    if(!buf)
+        return 1;
+    c1 = buf + (size_t)t->lblock*ni;
+    c2 = c1 + ni;
+
+    r1 = r2 = NULL;
+    for(l0 = 0; l0 <= t->lmax; l0 += t->lblock)
+    {
+        nl = t->lmax - l0 < t->lblock ? t->lmax - l0 + 1 : t->lblock;
+
+        for(l = l0; l < l0 + nl; ++l)
+        {
+            row = buf + (size_t)(l-l0)*ni;
+            if(l == 0)
+                for(i = 0; i < ni; ++i)
+                    row[i] = 1;
+            else if(l == 1)
+                memcpy(row, x, ni*sizeof(double));
+            else
+                for(i = 0; i < ni; ++i)
+                    row[i] = ((2*l-1)*x[i]*r1[i] - (l-1)*r2[i])/l;
+            r2 = r1;
+            r1 = row;
+        }
+
+        t->tile(t->arg, i0, ni, l0, nl, buf);
+
+        // keep the last two rows for the next tile
+        if(r2)
+            memcpy(c2, r2, ni*sizeof(double));
+        memcpy(c1, r1, ni*sizeof(double));
+        r1 = c1;
+        r2 = r2 ? c2 : NULL;
+    }
+
+    free(buf);
+
+    return 0;
+}
+
+int legendre_pl_tiles(int lmax, int n, const double* x, int xblock,
+                      int lblock, legendre_pl_tile* tile, void* arg,
+                      const struct wigner_exec* exec)
+{
+    struct tiles t;
+    int ntasks;
+
+    if(lmax < 0 || n < 0 || xblock < 1 || lblock < 1)
+        return 2;
+
+    ntasks = n/xblock + (n%xblock != 0);
+    if(ntasks == 0)
+        return 0;
+
+    t.lmax = lmax;
+    t.n = n;
+    t.xblock = xblock;
+    t.lblock = lblock;
+    t.x = x;
+    t.tile = tile;
+    t.arg = arg;
+
+    return wigner_exec_try(exec, ntasks, tiles_task, &t);
+}
@@ -0,0 +1,268 @@
+// compute associated Legendre functions for many arguments
+//
+// notes:
+// - all normalisations are computed from the orthonormal functions, whose
+//   recurrences in m and l have coefficients of order one and values that
+//   are bounded by sqrt((2l+1)/(4 pi)), and then multiplied by a factor
+//   that depends only on l and m
+// - the starting values P_mm contain sin(theta)^m, which underflows for
+//   large m near the poles; each value carries an integer exponent in units
+//   of PLM_SCALE bits, which is raised again once the recurrence in l has
+//   grown out of the range where the functions are negligible
+// - the recurrence in l runs for PLM_LANES arguments side by side, with the
+//   coefficients of each m computed once for a chunk of arguments; the
+//   exponents are only looked at while a lane is still scaled, so that the
+//   loop has no branches once all lanes are in range
+// - the unnormalised functions grow like (2m)! and overflow for large m,
+//   where their factors are themselves kept with an exponent until the
+//   final value is formed
+
+#include <stdlib.h>
+#include <math.h>
+
+#include "wigner.h"
+
+// number of arguments advanced together by the recurrence
+#ifndef PLM_LANES
+#define PLM_LANES 8
+#endif
+
+// number of arguments of each task, a multiple of PLM_LANES
+#ifndef PLM_CHUNK
+#define PLM_CHUNK 64
+#endif
+
+// bits of the exponent unit of scaled values
+#define PLM_SCALE 600
+
+#define PLM_NORM 0.28209479177387814347 // 1/sqrt(4 pi)
+
+// arguments of the functions, shared by their tasks
+struct plm
+{
+    int lmax, mmin, mmax, norm, n, all;
+    size_t stride;
+    const double* x;
+    double* p;
+};
+
+// factors of the normalisation norm for order m, as mantissa and exponent
+static void plm_factors(int norm, int m, int lmax, double* f, int* fe)
+{
+    int l, k, j;
+    double g;
+
+    for(l = m; l <= lmax; ++l)
+        fe[l] = 0;
+
+    if(norm == LEGENDRE_PLM_ORTHO)
+    {
+        for(l = m; l <= lmax; ++l)
+            f[l] = 1;
+    }
+    else if(norm == LEGENDRE_PLM_SCHMIDT)
+    {
+        // without the Condon-Shortley phase
+        for(l = m; l <= lmax; ++l)
+            f[l] = (1 - 2*(m&1))*sqrt((m > 0 ? 2 : 1)/(2*l+1.))/PLM_NORM;
+    }
+    else
+    {
+        // sqrt((l+m)!/(l-m)!), starting from sqrt((2m)!)
+        g = 1;
+        k = 0;
+        for(l = 2; l <= 2*m; ++l)
+        {
+            g = frexp(g*sqrt(l), &j);
+            k += j;
+        }
+        for(l = m; l <= lmax; ++l)
+        {
+            if(l > m)
+            {
+                g = frexp(g*sqrt((double)(l+m)/(l-m)), &j);
+                k += j;
+            }
+            f[l] = g*sqrt(1/(2*l+1.))/PLM_NORM;
+            fe[l] = k;
+        }
+    }
+}
+
+static int plm_task(void* arg, int task)
+{
+    const struct plm* t = arg;
+    int lmax, p0, np, p, k, nk, m, l, nsc;
+    double f, big, small;
+    double* work;
+    double* a;
+    double* b;
+    double* fac;
+    double* x;
+    double* s;
+    double* v;
+    int* fe;
+    int e[PLM_CHUNK], el[PLM_LANES];
+    double d0[PLM_LANES], d1[PLM_LANES], d2[PLM_LANES];
+    double* out[PLM_LANES];
+
+    lmax = t->lmax;
+    big = ldexp(1, PLM_SCALE);
+    small = ldexp(1, -PLM_SCALE);
+
+    p0 = task*PLM_CHUNK;
+    np = t->n - p0 < PLM_CHUNK ? t->n - p0 : PLM_CHUNK;
+
+    work = malloc((3*(lmax+1) + 3*PLM_CHUNK)*sizeof(double));
+    fe = malloc((lmax+1)*sizeof(int));
+    if(!work || !fe)
+    {
+        free(work);
+        free(fe);
+        return 1;
+    }
+    a = work;
+    b = a + lmax+1;
+    fac = b + lmax+1;
+    x = fac + lmax+1;
+    s = x + PLM_CHUNK;
+    v = s + PLM_CHUNK;
+
+    for(p = 0; p < PLM_CHUNK; ++p)
+    {
+        x[p] = p < np ? t->x[p0+p] : 0;
+        s[p] = sqrt((1 - x[p])*(1 + x[p]));
+        v[p] = PLM_NORM;
+        e[p] = 0;
+    }
+
+    for(m = 0; m <= t->mmax; ++m)
+    {
+        // P_mm = -sqrt((2m+1)/(2m)) sin(theta) P_{m-1,m-1}, scaled up as
+        // soon as it gets small
+        if(m > 0)
+        {
+            f = -sqrt((2*m+1)/(2.*m));
+            for(p = 0; p < np; ++p)
+            {
+                v[p] *= f*s[p];
+                if(fabs(v[p]) < small)
+                {
+                    v[p] *= big;
+                    e[p] -= 1;
+                }
+            }
+        }
+
+        if(m < t->mmin)
+            continue;
+
+        // P_lm = a_l (x P_{l-1,m} - b_l P_{l-2,m})
+        for(l = m+1; l <= lmax; ++l)
+        {
+            a[l] = sqrt((4.*l*l - 1)/((double)(l-m)*(l+m)));
+            b[l] = sqrt(((double)(l-1-m)*(l-1+m))/(4.*(l-1)*(l-1) - 1));
+        }
+
+        plm_factors(t->norm, m, lmax, fac, fe);
+
+        for(k = 0; k < np; k += PLM_LANES)
+        {
+            nk = np - k < PLM_LANES ? np - k : PLM_LANES;
+
+            nsc = 0;
+            for(p = 0; p < PLM_LANES; ++p)
+            {
+                out[p] = t->p + (size_t)(p0+k+(p < nk ? p : 0))*t->stride
+                              + (t->all ? wigner_alm_index(WIGNER_ALM_HEALPIX,
+                                                           lmax, m, m) : 0);
+                d0[p] = p < nk ? v[k+p] : 0;
+                d1[p] = 0;
+                el[p] = p < nk ? e[k+p] : 0;
+                nsc += el[p] < 0;
+            }
+
+            for(l = m; l <= lmax; ++l)
+            {
+                if(l > m)
+                {
+                    for(p = 0; p < PLM_LANES; ++p)
+                    {
+                        d2[p] = d1[p];
+                        d1[p] = d0[p];
+                        d0[p] = a[l]*(x[k+p]*d1[p] - b[l]*d2[p]);
+                    }
+                }
+
+                if(nsc == 0 && fe[l] == 0)
+                {
+                    for(p = 0; p < nk; ++p)
+                        out[p][l-m] = fac[l]*d0[p];
+                    continue;
+                }
+
+                // lanes that are still scaled, or factors with exponents
+                for(p = 0; p < nk; ++p)
+                {
+                    if(el[p] < 0 && fabs(d0[p]) > big)
+                    {
+                        d0[p] *= small;
+                        d1[p] *= small;
+                        el[p] += 1;
+                        nsc -= el[p] == 0;
+                    }
+                    out[p][l-m] = ldexp(fac[l]*d0[p], PLM_SCALE*el[p] + fe[l]);
+                }
+            }
+        }
+    }
+
+    free(work);
+    free(fe);
+
+    return 0;
+}
+
+static int plm_run(int lmax, int mmin, int mmax, int all, int norm, int n,
+                   const double* x, double* p, size_t stride,
+                   const struct wigner_exec* exec)
+{
+    struct plm t;
+    int ntasks;
+
+    if(lmax < 0 || mmin < 0 || mmax > lmax || n < 0
+       || (norm != LEGENDRE_PLM_ORTHO && norm != LEGENDRE_PLM_SCHMIDT
+           && norm != LEGENDRE_PLM_UNNORM))
+        return 2;
+
+    ntasks = (n + PLM_CHUNK-1)/PLM_CHUNK;
+    if(ntasks == 0)
+        return 0;
+
+    t.lmax = lmax;
+    t.mmin = mmin;
+    t.mmax = mmax;
+    t.norm = norm;
+    t.all = all;
+    t.n = n;
+    t.stride = stride;
+    t.x = x;
+    t.p = p;
+
+    return wigner_exec_try(exec, ntasks, plm_task, &t);
+}
+
+int legendre_plm(int lmax, int m, int norm, int n, const double* x,
+                 double* p, const struct wigner_exec* exec)
+{
+    return plm_run(lmax, m, m, 0, norm, n, x, p, (size_t)(lmax-m+1), exec);
+}
+
+int legendre_plm_all(int lmax, int norm, int n, const double* x, double* p,
+                     const struct wigner_exec* exec)
+{
+    if(lmax < 0)
+        return 2;
+    return plm_run(lmax, 0, lmax, 1, norm, n, x, p,
+                   wigner_alm_size(WIGNER_ALM_HEALPIX, lmax), exec);
+}
@@ -0,0 +1,159 @@
+// rotate sets of spherical harmonic coefficients by Euler angles
+//
+// notes:
+// - the rotated coefficients are b_lm = sum_m' D^l_{m,m'} a_lm' with the
+//   Wigner D-matrix D^l_{m,m'} = e^{-i m alpha} d^l_{m,m'}(beta)
+//   e^{-i m' gamma}, which rotates a field by the active rotation
+//   R = R_z(alpha) R_y(beta) R_z(gamma)
+// - the d-matrix is never stored: for each pair (m, m'), the row of
+//   d^l_{m,m'}(beta) in l is computed with wigner_dl_state, which is more
+//   accurate than the general recurrence of wigner_dl, and applied at once
+//   to all degrees; the row is used for (-m, -m') as well, by the symmetry
+//   d^l_{-m,-m'} = (-1)^(m-m') d^l_{m,m'}
+// - each task computes the output for one m >= 0 and its negative, so that
+//   the tasks write disjoint coefficients
+// - the coefficients in the HEALPix ordering are those of a real field, and
+//   are extended to m < 0 by a_{l,-m} = (-1)^m a_lm^* before rotating
+
+#include <stdlib.h>
+#include <math.h>
+
+#include "wigner.h"
+
+// arguments of the rotation, shared by its tasks
+struct rotate
+{
+    int lmax, order;
+    double alpha, beta;
+    const double* a;
+    double* alm;
+};
+
+static int rotate_task(void* arg, int task)
+{
+    const struct rotate* r = arg;
+    struct wigner_dl_state st;
+    int lmax, m, mp, l, lp, sg;
+    double c, s, re, im;
+    double* buf;
+    double* d;
+    double* bp;
+    double* bn;
+    const double* a;
+    size_t k;
+
+    lmax = r->lmax;
+    a = r->a;
+    m = task;
+
+    buf = malloc(5*(lmax+1)*sizeof(double));
+    if(!buf)
+        return 1;
+    d = buf;
+    bp = d + lmax+1;
+    bn = bp + 2*(lmax+1);
+
+    for(l = 0; l < 2*(lmax+1); ++l)
+        bp[l] = bn[l] = 0;
+
+    // sums over m' for m and -m, from the rows d^l_{m,m'} for l >= lp
+    for(mp = -lmax; mp <= lmax; ++mp)
+    {
+        lp = m > abs(mp) ? m : abs(mp);
+        wigner_dl_init(&st, m, mp, r->beta);
+        wigner_dl_advance(&st, lmax+1, d);
+        sg = (m - mp) & 1 ? -1 : 1;
+        for(l = lp; l <= lmax; ++l)
+        {
+            k = 2*wigner_alm_index(WIGNER_ALM_LM, lmax, l, mp);
+            bp[2*l] += d[l]*a[k];
+            bp[2*l+1] += d[l]*a[k+1];
+            k = 2*wigner_alm_index(WIGNER_ALM_LM, lmax, l, -mp);
+            bn[2*l] += sg*d[l]*a[k];
+            bn[2*l+1] += sg*d[l]*a[k+1];
+        }
+    }
+
+    // store with the phase e^{-i m alpha}
+    c = cos(m*r->alpha);
+    s = -sin(m*r->alpha);
+    for(l = m; l <= lmax; ++l)
+    {
+        re = bp[2*l];
+        im = bp[2*l+1];
+        k = 2*wigner_alm_index(r->order, lmax, l, m);
+        r->alm[k] = re*c - im*s;
+        r->alm[k+1] = re*s + im*c;
+        if(m > 0 && r->order == WIGNER_ALM_LM)
+        {
+            re = bn[2*l];
+            im = bn[2*l+1];
+            k = 2*wigner_alm_index(r->order, lmax, l, -m);
+            r->alm[k] = re*c + im*s;
+            r->alm[k+1] = -re*s + im*c;
+        }
+    }
+
+    free(buf);
+
+    return 0;
+}
+
+int rotate_alm(int lmax, int order, double alpha, double beta, double gamma,
+               double* alm, const struct wigner_exec* exec)
+{
+    struct rotate r;
+    int l, m, ier;
+    double c, s, re, im;
+    double* a;
+    size_t j, k;
+
+    if(lmax < 0 || (order != WIGNER_ALM_HEALPIX && order != WIGNER_ALM_LM))
+        return 2;
+
+    a = malloc(2*wigner_alm_size(WIGNER_ALM_LM, lmax)*sizeof(double));
+    if(!a)
+        return 1;
+
+    // all coefficients with the phase e^{-i m' gamma}
+    for(m = -lmax; m <= lmax; ++m)
+    {
+        c = cos(m*gamma);
+        s = -sin(m*gamma);
+        for(l = abs(m); l <= lmax; ++l)
+        {
+            k = 2*wigner_alm_index(WIGNER_ALM_LM, lmax, l, m);
+            if(order == WIGNER_ALM_LM)
+            {
+                re = alm[k];
+                im = alm[k+1];
+            }
+            else
+            {
+                j = 2*wigner_alm_index(order, lmax, l, abs(m));
+                re = alm[j];
+                im = alm[j+1];
+                if(m < 0)
+                {
+                    re = m & 1 ? -re : re;
+                    im = m & 1 ? im : -im;
+                }
+            }
+            a[k] = re*c - im*s;
+            a[k+1] = re*s + im*c;
+        }
+    }
+
+    r.lmax = lmax;
+    r.order = order;
+    r.alpha = alpha;
+    r.beta = beta;
+    r.a = a;
+    r.alm = alm;
+
+    ier = wigner_exec_try(exec, lmax+1, rotate_task, &r);
+
+    free(a);
+
+    return ier;
+}
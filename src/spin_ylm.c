@@ -0,0 +1,522 @@
+// compute spin-weighted spherical harmonics and their sums for many points
+//
+// notes:
+// - sY_lm(theta, phi) = (-1)^s sqrt((2l+1)/(4 pi)) d^l_{m,-s}(theta) e^{i m phi}
+//   with the d functions of wigner_dl, which is the Condon-Shortley phase for
+//   s = 0 and gives sY_lm^* = (-1)^(s+m) {-s}Y_{l,-m}
+// - the starting values of the recurrences in l are themselves computed by a
+//   recurrence in m, so that each costs a multiplication instead of powers
+//   and a binomial coefficient
+// - the recurrence in l runs for YLM_LANES points side by side, with the
+//   coefficients that depend only on l and m computed once for a chunk of
+//   points, so that the loop over points has no divisions or square roots
+// - the results for each point are stored in one of the usual orderings of
+//   alm, so that they can be used in place
+// - spin_synth sums the harmonics against alm as soon as they are computed,
+//   first over l for each m and point, then over m with the phases, so that
+//   no harmonics are stored and the state per point is a few numbers
+// - in the ordering WIGNER_ALM_HEALPIX, spin_synth takes a_{l,-m} = (-1)^m
+//   a_lm^* as rotate_alm does, so that a_l0 is real; for s = 0, the terms of
+//   m and -m are complex conjugates, and the sum over m > 0 is doubled instead
+
+#include <stdlib.h>
+#include <math.h>
+#include <float.h>
+
+#include "wigner.h"
+
+// number of points advanced together by the recurrence
+#ifndef YLM_LANES
+#define YLM_LANES 8
+#endif
+
+// number of points of each task, a multiple of YLM_LANES
+#ifndef YLM_CHUNK
+#define YLM_CHUNK 64
+#endif
+
+#define YLM_NORM 0.28209479177387814347 // 1/sqrt(4 pi)
+
+size_t wigner_alm_size(int order, int lmax)
+{
+    if(order == WIGNER_ALM_LM)
+        return (size_t)(lmax+1)*(lmax+1);
+    return (size_t)(lmax+1)*(lmax+2)/2;
+}
+
+size_t wigner_alm_index(int order, int lmax, int l, int m)
+{
+    if(order == WIGNER_ALM_LM)
+        return (size_t)l*(l+1) + m;
+    return (size_t)m*(2*lmax+1-m)/2 + l;
+}
+
+// binomial coefficient in floating point, exact as long as it fits
+static double binom(int n, int k)
+{
+    double b;
+    int i;
+
+    if(k > n/2)
+        k = n-k;
+
+    b = 1;
+    for(i = 1; i <= k; ++i, --n)
+        b = b*n/i;
+    return b;
+}
+
+// starting value d^lp_{n,m} of the recurrence in l as in wigner_dl, and the
+// starting degree lp
+static double ylm_start(int n, int m, double u, double v, int* lp)
+{
+    int a, b, c;
+    double f;
+
+    if(abs(n) > abs(m))
+    {
+        if(n > 0)
+            *lp = n, a = n - m, b = n + m, c = n - m;
+        else
+            *lp = -n, a = m - n, b = -n - m, c = 0;
+    }
+    else
+    {
+        if(m > 0)
+            *lp = m, a = m - n, b = n + m, c = 0;
+        else
+            *lp = -m, a = n - m, b = -n - m, c = n - m;
+    }
+
+    f = sqrt(binom(a+b, a));
+    if(f <= DBL_MAX)
+        f *= pow(u, a)*pow(v, b);
+    else
+        f = exp(0.5*(lgamma(a+b+1.) - lgamma(a+1.) - lgamma(b+1.))
+                + a*log(u) + b*log(v));
+    return (1 - 2*(c&1))*f;
+}
+
+// coefficients of d_l = (A_l x - B_l) d_{l-1} - C_l d_{l-2} for the spins
+// n, m from the starting degree lp on, which are those of the recurrence of
+// wigner_dl_advance; for n = m = 0, the first step is d_1 = x d_0
+static void ylm_coef(int n, int m, int lp, int lmax, double* abc)
+{
+    int l;
+    double L, r, s0, s1, j;
+
+    j = (double)n*m;
+    s1 = 0;
+    for(l = lp+1; l <= lmax; ++l)
+    {
+        L = l;
+        if(l == 1)
+        {
+            abc[3*l+0] = 1;
+            abc[3*l+1] = 0;
+            abc[3*l+2] = 0;
+            s1 = 1;
+            continue;
+        }
+        s0 = sqrt((L*L - (double)n*n)*(L*L - (double)m*m));
+        r = 1/((L-1)*s0);
+        abc[3*l+0] = (2*L-1)*L*(L-1)*r;
+        abc[3*l+1] = (2*L-1)*j*r;
+        abc[3*l+2] = L*s1*r;
+        s1 = s0;
+    }
+}
+
+// half angles u = sin(theta/2), v = cos(theta/2) and uv of a chunk of points,
+// and cos(theta) both as is and as rounded by wigner_dl; the unused lanes of
+// the last chunk are zero
+static void ylm_points(int np, const double* theta, double* u, double* v,
+                       double* x, double* xs, double* uv)
+{
+    int p;
+
+    for(p = 0; p < np; ++p)
+    {
+        u[p] = sin(0.5*theta[p]);
+        v[p] = cos(0.5*theta[p]);
+        x[p] = cos(theta[p]);
+        xs[p] = v[p]*v[p] - u[p]*u[p];
+        uv[p] = u[p]*v[p];
+    }
+    for(; p < YLM_CHUNK; ++p)
+        x[p] = xs[p] = 0;
+}
+
+// starting values of d^l_{m,-s} for m = sm and m = -sm, computed directly
+// while sm <= abs(s), and from those for sm-1 by the recurrence in m after;
+// returns the starting degree
+static int ylm_seeds(int s, int sm, int np, const double* u, const double* v,
+                     const double* uv, double* dp, double* dn)
+{
+    int p, lp;
+    double g;
+
+    if(sm <= abs(s))
+    {
+        for(p = 0; p < np; ++p)
+        {
+            dp[p] = ylm_start(sm, -s, u[p], v[p], &lp);
+            dn[p] = ylm_start(-sm, -s, u[p], v[p], &lp);
+        }
+    }
+    else
+    {
+        g = sqrt((2.*sm-1)*(2.*sm)/((double)(sm+s)*(sm-s)));
+        for(p = 0; p < np; ++p)
+        {
+            dp[p] *= -g*uv[p];
+            dn[p] *= g*uv[p];
+        }
+    }
+
+    return sm > abs(s) ? sm : abs(s);
+}
+
+// arguments of spin_ylm, shared by its tasks
+struct ylm
+{
+    int s, lmax, order, n;
+    const double* theta;
+    const double* phi;
+    double* y;
+};
+
+static int ylm_task(void* arg, int task)
+{
+    const struct ylm* t = arg;
+    int s, lmax, order, p0, np, p, k, nk, m, sm, lp, l, i;
+    size_t nalm, idx;
+    size_t* off;
+    double f;
+    double* work;
+    double* abc;
+    double* norm;
+    double* u;
+    double* v;
+    double* x;
+    double* xl;
+    double* xs;
+    double* uv;
+    double* cp;
+    double* sp;
+    double* dp;
+    double* dn;
+    double d0[YLM_LANES], d1[YLM_LANES], d2[YLM_LANES];
+    double* yk[YLM_LANES];
+
+    s = t->s;
+    lmax = t->lmax;
+    order = t->order;
+    nalm = wigner_alm_size(order, lmax);
+
+    p0 = task*YLM_CHUNK;
+    np = t->n - p0 < YLM_CHUNK ? t->n - p0 : YLM_CHUNK;
+
+    work = malloc((4*(lmax+1) + 9*YLM_CHUNK)*sizeof(double));
+    off = malloc((lmax+1)*sizeof(size_t));
+    if(!work || !off)
+    {
+        free(work);
+        free(off);
+        return 1;
+    }
+    abc = work;
+    norm = abc + 3*(lmax+1);
+    u = norm + lmax+1;
+    v = u + YLM_CHUNK;
+    x = v + YLM_CHUNK;
+    xs = x + YLM_CHUNK;
+    uv = xs + YLM_CHUNK;
+    cp = uv + YLM_CHUNK;
+    sp = cp + YLM_CHUNK;
+    dp = sp + YLM_CHUNK;
+    dn = dp + YLM_CHUNK;
+
+    for(l = 0; l <= lmax; ++l)
+        norm[l] = (1 - 2*(s&1))*YLM_NORM*sqrt(2*l+1);
+
+    ylm_points(np, t->theta + p0, u, v, x, xs, uv);
+
+    for(sm = 0; sm <= lmax; ++sm)
+    {
+        lp = ylm_seeds(s, sm, np, u, v, uv, dp, dn);
+
+        for(m = sm; m >= -sm; m -= 2*sm)
+        {
+            if(m < 0 && order != WIGNER_ALM_LM)
+                break;
+
+            ylm_coef(m, -s, lp, lmax, abc);
+
+            // cos(theta) as rounded by wigner_dl
+            xl = m == 0 && s == 0 ? x : xs;
+
+            for(p = 0; p < np; ++p)
+            {
+                cp[p] = cos(m*t->phi[p0+p]);
+                sp[p] = sin(m*t->phi[p0+p]);
+            }
+
+            // offsets of the degrees l in the ordering, relative to l = sm
+            idx = wigner_alm_index(order, lmax, sm, m);
+            for(l = sm; l <= lmax; ++l)
+                off[l] = 2*(wigner_alm_index(order, lmax, l, m) - idx);
+
+            for(k = 0; k < np; k += YLM_LANES)
+            {
+                nk = np - k < YLM_LANES ? np - k : YLM_LANES;
+
+                for(p = 0; p < YLM_LANES; ++p)
+                {
+                    i = p < nk ? p0+k+p : p0+k;
+                    yk[p] = t->y + 2*((size_t)i*nalm + idx);
+                    d0[p] = p < nk ? (m < 0 ? dn : dp)[k+p] : 0;
+                    d1[p] = 0;
+                }
+
+                // zeros below the starting degree
+                for(l = sm; l < lp && l <= lmax; ++l)
+                    for(p = 0; p < nk; ++p)
+                        yk[p][off[l]] = yk[p][off[l]+1] = 0;
+
+                for(p = 0; p < nk && lp <= lmax; ++p)
+                {
+                    f = norm[lp]*d0[p];
+                    yk[p][off[lp]] = f*cp[k+p];
+                    yk[p][off[lp]+1] = f*sp[k+p];
+                }
+
+                for(l = lp+1; l <= lmax; ++l)
+                {
+                    for(p = 0; p < YLM_LANES; ++p)
+                    {
+                        d2[p] = d1[p];
+                        d1[p] = d0[p];
+                        d0[p] = (abc[3*l]*xl[k+p] - abc[3*l+1])*d1[p]
+                                                        - abc[3*l+2]*d2[p];
+                    }
+                    for(p = 0; p < nk; ++p)
+                    {
+                        f = norm[l]*d0[p];
+                        yk[p][off[l]] = f*cp[k+p];
+                        yk[p][off[l]+1] = f*sp[k+p];
+                    }
+                }
+            }
+
+            if(sm == 0)
+                break;
+        }
+    }
+
+    free(work);
+    free(off);
+
+    return 0;
+}
+
+int spin_ylm(int s, int lmax, int order, int n, const double* theta,
+             const double* phi, double* y, const struct wigner_exec* exec)
+{
+    struct ylm t;
+    int ntasks;
+
+    if(lmax < 0 || n < 0
+       || (order != WIGNER_ALM_HEALPIX && order != WIGNER_ALM_LM))
+        return 2;
+
+    ntasks = (n + YLM_CHUNK-1)/YLM_CHUNK;
+    if(ntasks == 0)
+        return 0;
+
+    t.s = s;
+    t.lmax = lmax;
+    t.order = order;
+    t.n = n;
+    t.theta = theta;
+    t.phi = phi;
+    t.y = y;
+
+    return wigner_exec_try(exec, ntasks, ylm_task, &t);
+}
+
+// arguments of spin_synth, shared by its tasks
+struct synth
+{
+    int s, lmax, order, n;
+    const double* alm;
+    const double* theta;
+    const double* phi;
+    double* f;
+};
+
+static int synth_task(void* arg, int task)
+{
+    const struct synth* t = arg;
+    int s, lmax, order, p0, np, p, k, m, sm, lp, l, real;
+    double c, e, wr, wi;
+    double* work;
+    double* abc;
+    double* norm;
+    double* ar;
+    double* ai;
+    double* u;
+    double* v;
+    double* x;
+    double* xl;
+    double* xs;
+    double* uv;
+    double* dp;
+    double* dn;
+    double* fr;
+    double* fi;
+    double d0[YLM_LANES], d1[YLM_LANES], d2[YLM_LANES];
+    double gr[YLM_LANES], gi[YLM_LANES];
+
+    s = t->s;
+    lmax = t->lmax;
+    order = t->order;
+    real = order == WIGNER_ALM_HEALPIX && s == 0;
+
+    p0 = task*YLM_CHUNK;
+    np = t->n - p0 < YLM_CHUNK ? t->n - p0 : YLM_CHUNK;
+
+    work = malloc((6*(lmax+1) + 9*YLM_CHUNK)*sizeof(double));
+    if(!work)
+        return 1;
+    abc = work;
+    norm = abc + 3*(lmax+1);
+    ar = norm + lmax+1;
+    ai = ar + lmax+1;
+    u = ai + lmax+1;
+    v = u + YLM_CHUNK;
+    x = v + YLM_CHUNK;
+    xs = x + YLM_CHUNK;
+    uv = xs + YLM_CHUNK;
+    dp = uv + YLM_CHUNK;
+    dn = dp + YLM_CHUNK;
+    fr = dn + YLM_CHUNK;
+    fi = fr + YLM_CHUNK;
+
+    for(l = 0; l <= lmax; ++l)
+        norm[l] = (1 - 2*(s&1))*YLM_NORM*sqrt(2*l+1);
+
+    ylm_points(np, t->theta + p0, u, v, x, xs, uv);
+
+    for(p = 0; p < YLM_CHUNK; ++p)
+        fr[p] = fi[p] = 0;
+
+    for(sm = 0; sm <= lmax; ++sm)
+    {
+        lp = ylm_seeds(s, sm, np, u, v, uv, dp, dn);
+        if(lp > lmax)
+            continue;
+
+        for(m = sm; m >= -sm; m -= 2*sm)
+        {
+            if(m < 0 && real)
+                break;
+
+            ylm_coef(m, -s, lp, lmax, abc);
+
+            // cos(theta) as rounded by wigner_dl
+            xl = m == 0 && s == 0 ? x : xs;
+
+            // normalised alm of this m, from those of m = sm in the ordering
+            // WIGNER_ALM_HEALPIX
+            wr = wi = real && m > 0 ? 2 : 1;
+            if(m == 0 && order != WIGNER_ALM_LM)
+                wi = 0;
+            if(m < 0 && order != WIGNER_ALM_LM)
+            {
+                wr = sm & 1 ? -1 : 1;
+                wi = -wr;
+            }
+            for(l = lp; l <= lmax; ++l)
+            {
+                k = 2*wigner_alm_index(order, lmax, l,
+                                       order == WIGNER_ALM_LM ? m : sm);
+                ar[l] = wr*norm[l]*t->alm[k];
+                ai[l] = wi*norm[l]*t->alm[k+1];
+            }
+
+            for(k = 0; k < np; k += YLM_LANES)
+            {
+                for(p = 0; p < YLM_LANES; ++p)
+                {
+                    d0[p] = k+p < np ? (m < 0 ? dn : dp)[k+p] : 0;
+                    d1[p] = 0;
+                    gr[p] = ar[lp]*d0[p];
+                    gi[p] = ai[lp]*d0[p];
+                }
+
+                for(l = lp+1; l <= lmax; ++l)
+                {
+                    for(p = 0; p < YLM_LANES; ++p)
+                    {
+                        d2[p] = d1[p];
+                        d1[p] = d0[p];
+                        d0[p] = (abc[3*l]*xl[k+p] - abc[3*l+1])*d1[p]
+                                                        - abc[3*l+2]*d2[p];
+                        gr[p] += ar[l]*d0[p];
+                        gi[p] += ai[l]*d0[p];
+                    }
+                }
+
+                // multiply by the phase e^{i m phi}
+                for(p = 0; p < YLM_LANES && k+p < np; ++p)
+                {
+                    c = cos(m*t->phi[p0+k+p]);
+                    e = sin(m*t->phi[p0+k+p]);
+                    fr[k+p] += gr[p]*c - gi[p]*e;
+                    fi[k+p] += gr[p]*e + gi[p]*c;
+                }
+            }
+
+            if(sm == 0)
+                break;
+        }
+    }
+
+    for(p = 0; p < np; ++p)
+    {
+        t->f[2*(p0+p)] = fr[p];
+        t->f[2*(p0+p)+1] = real ? 0 : fi[p];
+    }
+
+    free(work);
+
+    return 0;
+}
+
+int spin_synth(int s, int lmax, int order, const double* alm, int n,
+               const double* theta, const double* phi, double* f,
+               const struct wigner_exec* exec)
+{
+    struct synth t;
+    int ntasks;
+
+    if(lmax < 0 || n < 0
+       || (order != WIGNER_ALM_HEALPIX && order != WIGNER_ALM_LM))
+        return 2;
+
+    ntasks = (n + YLM_CHUNK-1)/YLM_CHUNK;
+    if(ntasks == 0)
+        return 0;
+
+    t.s = s;
+    t.lmax = lmax;
+    t.order = order;
+    t.n = n;
+    t.alm = alm;
+    t.theta = theta;
+    t.phi = phi;
+    t.f = f;
+
+    return wigner_exec_try(exec, ntasks, synth_task, &t);
+}
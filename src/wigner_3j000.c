@@ -0,0 +1,136 @@
+// compute the packed tensor of Wigner 3j symbols (l1 l2 l3; 0 0 0)
+//
+// notes:
+// - the symbols are invariant under permutations of (l1, l2, l3) and vanish
+//   unless the triangle conditions hold and l1 + l2 + l3 is even, so only
+//   l1 <= l2 <= l3 <= l1 + l2 with even sum are stored
+// - storage is ordered by l3, then l2, then l1, so that l1 runs in steps of
+//   two over a contiguous row for each pair (l2, l3), and the index of each
+//   symbol has a closed form without any lookup table
+// - the rows of each slab l3 are computed with wigner_3jj, one task per slab,
+//   largest slabs first
+
+#include <stdlib.h>
+
+#include "wigner.h"
+
+// offset of the slab l3, from the number (p+1)(p+2)/2 of symbols in each of
+// the two slabs l3 = 2p and l3 = 2p+1
+static size_t slab(int l3)
+{
+    size_t p = (size_t)(l3/2);
+
+    return p*(p+1)*(p+2)/3 + (l3 & 1)*(p+1)*(p+2)/2;
+}
+
+size_t wigner_3j000_size(int lmax)
+{
+    return lmax < 0 ? 0 : slab(lmax+1);
+}
+
+size_t wigner_3j000_index(int l1, int l2, int l3)
+{
+    size_t j = (size_t)(l2 - (l3+1)/2);
+
+    return slab(l3) + j*(j+1)/2 + (size_t)((l1 - l3 + l2)/2);
+}
+
+double wigner_3j000_get(int lmax, const double* t, int l1, int l2, int l3)
+{
+    int l;
+
+    // sort so that l1 <= l2 <= l3
+    if(l1 > l2)
+        l = l1, l1 = l2, l2 = l;
+    if(l2 > l3)
+        l = l2, l2 = l3, l3 = l;
+    if(l1 > l2)
+        l = l1, l1 = l2, l2 = l;
+
+    if(l1 < 0 || l3 > lmax || l3 > l1 + l2 || ((l1 + l2 + l3) & 1))
+        return 0;
+
+    return t[wigner_3j000_index(l1, l2, l3)];
+}
+
+const double* wigner_3j000_row(const double* t, int l2, int l3, int* l1min,
+                               int* l1max)
+{
+    *l1min = l3 - l2;
+    *l1max = l3 - l2 + 2*((2*l2 - l3)/2);
+    return t + wigner_3j000_index(*l1min, l2, l3);
+}
+
+void wigner_3j000_first(struct wigner_3j000_iter* it)
+{
+    it->l1 = it->l2 = it->l3 = 0;
+    it->i = 0;
+}
+
+void wigner_3j000_next(struct wigner_3j000_iter* it)
+{
+    it->i += 1;
+    it->l1 += 2;
+    if(it->l1 <= it->l2)
+        return;
+    it->l2 += 1;
+    if(it->l2 > it->l3)
+    {
+        it->l3 += 1;
+        it->l2 = (it->l3+1)/2;
+    }
+    it->l1 = it->l3 - it->l2;
+}
+
+// arguments of the fill, shared by its tasks
+struct fill
+{
+    int lmax;
+    double* t;
+};
+
+static int fill_slab(void* arg, int task)
+{
+    const struct fill* f = arg;
+    int l2, l3, lmin, lmax, k, n, ier;
+    double* buf;
+    double* row;
+
+    l3 = f->lmax - task;
+
+    buf = malloc((2*l3+1)*sizeof(double));
+    if(!buf)
+        return 1;
+
+    ier = 0;
+    row = f->t + slab(l3);
+    for(l2 = (l3+1)/2; l2 <= l3; ++l2)
+    {
+        n = (2*l2 - l3)/2 + 1;
+        if(wigner_3jj_int(l2, l3, 0, 0, &lmin, &lmax, buf, 2*l3+1))
+        {
+            ier = 1;
+            break;
+        }
+        for(k = 0; k < n; ++k)
+            row[k] = buf[2*k];
+        row += n;
+    }
+
+    free(buf);
+
+    return ier;
+}
+
+int wigner_3j000_fill(int lmax, double* t, const struct wigner_exec* exec)
+{
+    struct fill f;
+
+    if(lmax < 0)
+        return 0;
+
+    f.lmax = lmax;
+    f.t = t;
+
+    return wigner_exec_try(exec, lmax+1, fill_slab, &f);
+}
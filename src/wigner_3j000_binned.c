@@ -0,0 +1,192 @@
+// compute binned sums of squared 3j symbols with zero spins
+//
+// notes:
+// - these are the sums of bispectrum estimators and their normalisation, with
+//   separable weights in l1, l2, l3 that carry the spectra, filters, or the
+//   factors (2l+1)
+// - each row of wigner_3jj in l1 for fixed (l2, l3) is reduced into the bins
+//   of l1 as soon as it is computed, so that no symbols are stored
+// - the symbols are symmetric in (l2, l3), so rows are computed for l2 <= l3
+//   only, and each is added with the weights of both orders
+// - the degrees l2 are split into tasks of about equal cost, each within a
+//   single bin b2 and with its own partial sums for (b1, b2, b3) and for
+//   (b1, b3, b2), which are added in order at the end
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "wigner.h"
+
+// number of tasks, independent of the number of threads
+#ifndef BINNED_TASKS
+#define BINNED_TASKS 256
+#endif
+
+// arguments and partial sums of the binned sums, shared by the tasks
+struct binned
+{
+    int nbins, lmin, lmax;
+    const int* bin;
+    const int* first;
+    const double* w1;
+    const double* w2;
+    const double* w3;
+    double* part;
+};
+
+static int binned_task(void* arg, int task)
+{
+    const struct binned* b = arg;
+    int nb, l1, l2, l3, l1min, l1max, lo, hi, b1, b3, bmin, bmax;
+    double x, w23, w32;
+    double* buf;
+    double* s;
+    double* part;
+    double* swap;
+
+    nb = b->nbins;
+    part = b->part + (size_t)task*2*nb*nb;
+    swap = part + nb*nb;
+
+    buf = malloc((2*b->lmax+1 + nb)*sizeof(double));
+    if(!buf)
+        return 1;
+    s = buf + 2*b->lmax+1;
+    for(b1 = 0; b1 < nb; ++b1)
+        s[b1] = 0;
+
+    for(l2 = b->first[task]; l2 < b->first[task+1]; ++l2)
+    {
+        for(l3 = l2; l3 <= b->lmax; ++l3)
+        {
+            // only the part of the row in l1 that lies in the bins
+            lo = l2 > l3 ? l2 - l3 : l3 - l2;
+            hi = l2 + l3;
+            if(lo < b->lmin)
+                lo = b->lmin + ((b->lmin - lo) & 1);
+            if(hi > b->lmax)
+                hi = b->lmax - ((hi - b->lmax) & 1);
+            if(lo > hi)
+                continue;
+
+            wigner_3jj_int(l2, l3, 0, 0, &l1min, &l1max, buf, 2*b->lmax+1);
+
+            for(l1 = lo; l1 <= hi; l1 += 2)
+            {
+                x = buf[l1-l1min];
+                s[b->bin[l1-b->lmin]] += (b->w1 ? b->w1[l1] : 1)*x*x;
+            }
+
+            bmin = b->bin[lo-b->lmin];
+            bmax = b->bin[hi-b->lmin];
+            b3 = b->bin[l3-b->lmin];
+            w23 = (b->w2 ? b->w2[l2] : 1)*(b->w3 ? b->w3[l3] : 1);
+            w32 = l3 > l2 ? (b->w2 ? b->w2[l3] : 1)*(b->w3 ? b->w3[l2] : 1)
+                          : 0;
+            for(b1 = bmin; b1 <= bmax; ++b1)
+            {
+                part[b1*nb+b3] += w23*s[b1];
+                swap[b1*nb+b3] += w32*s[b1];
+                s[b1] = 0;
+            }
+        }
+    }
+
+    free(buf);
+
+    return 0;
+}
+
+// number of coefficients computed by wigner_3jj for l2 and all l3 >= l2
+static double row_cost(int lmax, int l2)
+{
+    return (double)(lmax-l2+1)*(2*l2+1);
+}
+
+int wigner_3j000_binned(int nbins, const int* edges, const double* w1,
+                        const double* w2, const double* w3, double* out,
+                        const struct wigner_exec* exec)
+{
+    struct binned b;
+    int i, k, l, l2, b2, nl, ntasks, ier;
+    size_t nb2;
+    int* bin;
+    int* first;
+    double cost, total;
+
+    if(nbins < 1 || edges[0] < 0)
+        return 2;
+    for(i = 0; i < nbins; ++i)
+        if(edges[i+1] <= edges[i])
+            return 2;
+
+    b.nbins = nbins;
+    b.lmin = edges[0];
+    b.lmax = edges[nbins]-1;
+    b.w1 = w1;
+    b.w2 = w2;
+    b.w3 = w3;
+
+    nl = b.lmax - b.lmin + 1;
+    nb2 = (size_t)nbins*nbins;
+
+    bin = malloc((nl + BINNED_TASKS + nbins + 1)*sizeof(int));
+    if(!bin)
+        return 1;
+    first = bin + nl;
+
+    for(i = 0; i < nbins; ++i)
+        for(l = edges[i]; l < edges[i+1]; ++l)
+            bin[l-b.lmin] = i;
+
+    total = 0;
+    for(l2 = b.lmin; l2 <= b.lmax; ++l2)
+        total += row_cost(b.lmax, l2);
+
+    // tasks of about equal cost, which never span two bins
+    ntasks = 0;
+    cost = 0;
+    for(l2 = b.lmin; l2 <= b.lmax; ++l2)
+    {
+        if(l2 == b.lmin || bin[l2-b.lmin] != bin[l2-1-b.lmin]
+           || cost >= total/BINNED_TASKS)
+        {
+            first[ntasks++] = l2;
+            cost = 0;
+        }
+        cost += row_cost(b.lmax, l2);
+    }
+    first[ntasks] = b.lmax+1;
+
+    b.bin = bin;
+    b.first = first;
+    b.part = calloc(2*ntasks*nb2, sizeof(double));
+    if(!b.part)
+    {
+        free(bin);
+        return 1;
+    }
+
+    ier = wigner_exec_try(exec, ntasks, binned_task, &b);
+
+    // add the partial sums in order
+    memset(out, 0, nb2*nbins*sizeof(double));
+    for(k = 0; k < ntasks; ++k)
+    {
+        b2 = bin[first[k]-b.lmin];
+        for(i = 0; i < nbins; ++i)
+        {
+            for(l = 0; l < nbins; ++l)
+            {
+                out[((size_t)i*nbins+b2)*nbins+l] += b.part[2*k*nb2+i*nbins+l];
+                out[((size_t)i*nbins+l)*nbins+b2] +=
+                    b.part[(2*k+1)*nb2+i*nbins+l];
+            }
+        }
+    }
+
+    free(b.part);
+    free(bin);
+
+    return ier;
+}
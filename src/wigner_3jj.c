@@ -23,6 +23,16 @@
 // -----
 // int wigner_3jj(double l2, double l3, double m2, double m3, double* l1min,
 //                double* l1max, double* thrcof, int ndim);
+// int wigner_3jj_int(int l2, int l3, int m2, int m3, int* l1min, int* l1max,
+//                    double* thrcof, int ndim);
+// int wigner_3jj_twoj(int two_l2, int two_l3, int two_m2, int two_m3,
+//                     int* two_l1min, int* two_l1max, double* thrcof,
+//                     int ndim);
+//
+// The `_int` variant takes integer arguments, and the `_twoj` variant takes
+// twice the (half-)integer arguments, as do its outputs `two_l1min` and
+// `two_l1max`.  Both check their arguments exactly in integer arithmetic and
+// return the same error flags, then run the same recursion.
 //
 // Arguments
 // ---------
@@ -126,22 +136,32 @@
 // 04 Nov 2020  Translation to C by N. Tessore.
 //
 
+#include <stdlib.h>
 #include <math.h>
 #include <float.h>
 
+#include "wigner_stats.h"
+
 static inline int phase(int m)
 {
     return 1-2*(m&1);
 }
 
-int wigner_3jj(double l2, double l3, double m2, double m3, double* l1min_out,
-               double* l1max_out, double* thrcof, int ndim)
+static inline int imax(int a, int b)
+{
+    return a > b ? a : b;
+}
+
+// Recursion for the 3j coefficients once the arguments have been checked.
+static void wigner_3jj_rec(double l2, double l3, double m2, double m3,
+                           double l1min, double l1max, int nfin,
+                           double* thrcof)
 {
     // variables
-    int i, index, lstep, n, nfin, nfinp1, nfinp2, nlim, nstep2;
-    double a1, a1s, a2, a2s, c1, c1old, c2, cnorm, denom, dv, l1, l1min, l1max,
-           newfac, oldfac, ratio, sign1, sign2, sum1, sum2, sumbac, sumfor,
-           sumuni, thresh, x, x1, x2, x3, y, y1, y2, y3;
+    int i, index, lstep, n, nfinp1, nfinp2, nlim, nstep2;
+    double a1, a1s, a2, a2s, c1, c1old, c2, cnorm, denom, dv, l1, newfac,
+           oldfac, ratio, sign1, sign2, sum1, sum2, sumbac, sumfor, sumuni,
+           thresh, x, x1, x2, x3, y, y1, y2, y3;
 
     // constants
     const double eps = .01;
@@ -155,43 +175,14 @@ int wigner_3jj(double l2, double l3, double m2, double m3, double* l1min_out,
 
     const double m1 = - m2 - m3;
 
-    // Check error condition 1.
-    if((l2-fabs(m2) + eps < 0) || (l3-fabs(m3) + eps < 0))
-        return 1;
-
-    // Check error condition 2.
-    if((fmod(l2+fabs(m2)+eps, 1) >= eps+eps) ||
-            (fmod(l3+fabs(m3)+eps, 1) >= eps+eps))
-       return 2;
-
-    // Limits for l1
-    *l1min_out = l1min = fmax(fabs(l2-l3), fabs(m1));
-    *l1max_out = l1max = l2 + l3;
-
-    // Check error condition 3.
-    if(fmod(l1max-l1min+eps, 1) >= eps+eps)
-        return 3;
-
-    //  Check error condition 4.
-    if(l1min >= l1max+eps)
-        return 4;
-
-    // Only report l1min and l1max.
-    if(!thrcof)
-        return 0;
-
-    // Number of coefficients to compute.
-    nfin = l1max-l1min+1+eps;
-
-    // Check error condition 5.
-    if(ndim < nfin)
-        return 5;
+    WIGNER_STATS_ADD(WIGNER_STATS_3JJ, calls, 1);
+    WIGNER_STATS_ADD(WIGNER_STATS_3JJ, coefs, nfin);
 
     // Check whether l1 can take only one value, ie. l1min = l1max.
     if(l1min >= l1max-eps)
     {
         thrcof[0] = phase(fabs(l2+m2-l3+m3)+eps)/sqrt(l1min + l2 + l3 + 1);
-        return 0;
+        return;
     }
 
     // This is reached in case that l1 takes more than one value,
@@ -258,13 +249,17 @@ int wigner_3jj(double l2, double l3, double m2, double m3, double* l1min_out,
                 for(i = 0; i < lstep; ++i)
                 {
                     if(fabs(thrcof[i]) < srtiny)
+                    {
                         thrcof[i] = 0;
+                        WIGNER_STATS_ADD(WIGNER_STATS_3JJ, zeroed, 1);
+                    }
                     else
                         thrcof[i] = thrcof[i] / srhuge;
                 }
                 sum1 = sum1 / huge;
                 sumfor = sumfor / huge;
                 x = x / srhuge;
+                WIGNER_STATS_ADD(WIGNER_STATS_3JJ, rescales, 1);
             }
 
             // As long as abs(c1) is decreasing, the recursion proceeds towards
@@ -276,6 +271,8 @@ int wigner_3jj(double l2, double l3, double m2, double m3, double* l1min_out,
         }
     }
 
+    WIGNER_STATS_ADD(WIGNER_STATS_3JJ, fwd_steps, lstep-1);
+
     // Keep three 3j coefficients around lmatch for comparison with
     // backward recursion.
     x1 = x;
@@ -338,16 +335,22 @@ int wigner_3jj(double l2, double l3, double m2, double m3, double* l1min_out,
                 {
                     index = nfin - i;
                     if(fabs(thrcof[index]) < srtiny)
+                    {
                         thrcof[index] = 0;
+                        WIGNER_STATS_ADD(WIGNER_STATS_3JJ, zeroed, 1);
+                    }
                     else
                         thrcof[index] = thrcof[index] / srhuge;
                 }
                 sum2 = sum2 / huge;
                 sumbac = sumbac / huge;
+                WIGNER_STATS_ADD(WIGNER_STATS_3JJ, rescales, 1);
             }
         }
     }
 
+    WIGNER_STATS_ADD(WIGNER_STATS_3JJ, bwd_steps, lstep-1);
+
     // The forward recursion 3j coefficients x1, x2, x3 are to be matched
     // with the corresponding backward recursion values y1, y2, y3.
     y3 = y;
@@ -376,6 +379,8 @@ int wigner_3jj(double l2, double l3, double m2, double m3, double* l1min_out,
     goto norm;
 
     nobac:
+    WIGNER_STATS_ADD(WIGNER_STATS_3JJ, fwd_steps, 1);
+    WIGNER_STATS_ADD(WIGNER_STATS_3JJ, nobac, 1);
     sumuni = sum1;
 
     // Normalize 3j coefficients
@@ -394,7 +399,10 @@ int wigner_3jj(double l2, double l3, double m2, double m3, double* l1min_out,
         for(n = 0; n < nfin; ++n)
         {
             if(fabs(thrcof[n]) < thresh)
+            {
                 thrcof[n] = 0;
+                WIGNER_STATS_ADD(WIGNER_STATS_3JJ, zeroed, 1);
+            }
             else
                 thrcof[n] = cnorm * thrcof[n];
         }
@@ -404,6 +412,132 @@ int wigner_3jj(double l2, double l3, double m2, double m3, double* l1min_out,
         for(n = 0; n < nfin; ++n)
             thrcof[n] = cnorm * thrcof[n];
     }
+}
+
+int wigner_3jj(double l2, double l3, double m2, double m3, double* l1min_out,
+               double* l1max_out, double* thrcof, int ndim)
+{
+    // variables
+    int nfin;
+    double l1min, l1max;
+
+    // constants
+    const double eps = .01;
+
+    const double m1 = - m2 - m3;
+
+    // Check error condition 1.
+    if((l2-fabs(m2) + eps < 0) || (l3-fabs(m3) + eps < 0))
+        return 1;
+
+    // Check error condition 2.
+    if((fmod(l2+fabs(m2)+eps, 1) >= eps+eps) ||
+            (fmod(l3+fabs(m3)+eps, 1) >= eps+eps))
+       return 2;
+
+    // Limits for l1
+    *l1min_out = l1min = fmax(fabs(l2-l3), fabs(m1));
+    *l1max_out = l1max = l2 + l3;
+
+    // Check error condition 3.
+    if(fmod(l1max-l1min+eps, 1) >= eps+eps)
+        return 3;
+
+    //  Check error condition 4.
+    if(l1min >= l1max+eps)
+        return 4;
+
+    // Only report l1min and l1max.
+    if(!thrcof)
+        return 0;
+
+    // Number of coefficients to compute.
+    nfin = l1max-l1min+1+eps;
+
+    // Check error condition 5.
+    if(ndim < nfin)
+        return 5;
+
+    wigner_3jj_rec(l2, l3, m2, m3, l1min, l1max, nfin, thrcof);
+
+    return 0;
+}
+
+int wigner_3jj_int(int l2, int l3, int m2, int m3, int* l1min_out,
+                   int* l1max_out, double* thrcof, int ndim)
+{
+    // variables
+    int l1min, l1max, nfin;
+
+    // Check error condition 1.  Error conditions 2 and 3 cannot occur for
+    // integer arguments.
+    if(l2 < abs(m2) || l3 < abs(m3))
+        return 1;
+
+    // Limits for l1
+    *l1min_out = l1min = imax(abs(l2-l3), abs(m2+m3));
+    *l1max_out = l1max = l2 + l3;
+
+    //  Check error condition 4.
+    if(l1min > l1max)
+        return 4;
+
+    // Only report l1min and l1max.
+    if(!thrcof)
+        return 0;
+
+    // Number of coefficients to compute.
+    nfin = l1max-l1min+1;
+
+    // Check error condition 5.
+    if(ndim < nfin)
+        return 5;
+
+    wigner_3jj_rec(l2, l3, m2, m3, l1min, l1max, nfin, thrcof);
+
+    return 0;
+}
+
+int wigner_3jj_twoj(int two_l2, int two_l3, int two_m2, int two_m3,
+                    int* two_l1min_out, int* two_l1max_out, double* thrcof,
+                    int ndim)
+{
+    // variables
+    int two_l1min, two_l1max, nfin;
+
+    // Check error condition 1.
+    if(two_l2 < abs(two_m2) || two_l3 < abs(two_m3))
+        return 1;
+
+    // Check error condition 2.
+    if(((two_l2+two_m2)&1) || ((two_l3+two_m3)&1))
+        return 2;
+
+    // Limits for l1
+    *two_l1min_out = two_l1min = imax(abs(two_l2-two_l3), abs(two_m2+two_m3));
+    *two_l1max_out = two_l1max = two_l2 + two_l3;
+
+    // Check error condition 3.
+    if((two_l1max-two_l1min)&1)
+        return 3;
+
+    //  Check error condition 4.
+    if(two_l1min > two_l1max)
+        return 4;
+
+    // Only report l1min and l1max.
+    if(!thrcof)
+        return 0;
+
+    // Number of coefficients to compute.
+    nfin = (two_l1max-two_l1min)/2+1;
+
+    // Check error condition 5.
+    if(ndim < nfin)
+        return 5;
+
+    wigner_3jj_rec(0.5*two_l2, 0.5*two_l3, 0.5*two_m2, 0.5*two_m3,
+                   0.5*two_l1min, 0.5*two_l1max, nfin, thrcof);
 
     return 0;
 }
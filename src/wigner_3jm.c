@@ -23,6 +23,16 @@
 // -----
 // int wigner_3jm(double l1, double l2, double l3, double m1, double* m2min,
 //                double* m2max, double* thrcof, int ndim);
+// int wigner_3jm_int(int l1, int l2, int l3, int m1, int* m2min, int* m2max,
+//                    double* thrcof, int ndim);
+// int wigner_3jm_twoj(int two_l1, int two_l2, int two_l3, int two_m1,
+//                     int* two_m2min, int* two_m2max, double* thrcof,
+//                     int ndim);
+//
+// The `_int` variant takes integer arguments, and the `_twoj` variant takes
+// twice the (half-)integer arguments, as do its outputs `two_m2min` and
+// `two_m2max`.  Both check their arguments exactly in integer arithmetic and
+// return the same error flags, then run the same recursion.
 //
 // Arguments
 // ---------
@@ -128,22 +138,37 @@
 // 04 Nov 2020  Translation to C by N. Tessore.
 //
 
+#include <stdlib.h>
 #include <math.h>
 #include <float.h>
 
+#include "wigner_stats.h"
+
 static inline int phase(int m)
 {
     return 1-2*(m&1);
 }
 
-int wigner_3jm(double l1, double l2, double l3, double m1, double* m2min_out,
-               double* m2max_out, double* thrcof, int ndim)
+static inline int imin(int a, int b)
+{
+    return a < b ? a : b;
+}
+
+static inline int imax(int a, int b)
+{
+    return a > b ? a : b;
+}
+
+// Recursion for the 3j coefficients once the arguments have been checked.
+static void wigner_3jm_rec(double l1, double l2, double l3, double m1,
+                           double m2min, double m2max, int nfin,
+                           double* thrcof)
 {
     // variables
-    int i, index, lstep, n, nfin, nfinp1, nfinp2, nlim, nstep2;
-    double a1, a1s, c1, c1old, c2, cnorm, dv, m2, m2min, m2max, m3, newfac,
-           oldfac, ratio, sign1, sign2, sum1, sum2, sumbac, sumfor, sumuni,
-           thresh, x, x1, x2, x3, y, y1, y2, y3;
+    int i, index, lstep, n, nfinp1, nfinp2, nlim, nstep2;
+    double a1, a1s, c1, c1old, c2, cnorm, dv, m2, m3, newfac, oldfac, ratio,
+           sign1, sign2, sum1, sum2, sumbac, sumfor, sumuni, thresh, x, x1, x2,
+           x3, y, y1, y2, y3;
 
     // constants
     const double eps = .01;
@@ -155,46 +180,14 @@ int wigner_3jm(double l1, double l2, double l3, double m1, double* m2min_out,
     const double tiny = 1.0/huge;
     const double srtiny = 1.0/srhuge;
 
-    // Check error condition 1.
-    if((l1-fabs(m1)+eps < 0) || (fmod(l1+fabs(m1)+eps, 1) >= eps+eps))
-        return 1;
-
-    // Check error condition 2.
-    if((l1+l2-l3 < -eps) || (l1-l2+l3 < -eps) || (-l1+l2+l3 < -eps))
-       return 2;
-
-    // Check error condition 3.
-    if(fmod(l1+l2+l3+eps, 1) >= eps+eps)
-        return 3;
-
-    // Limits for m2
-    *m2min_out = m2min = fmax(-l2, -l3-m1);
-    *m2max_out = m2max = fmin(l2, l3-m1);
-
-    // Check error condition 4.
-    if(fmod(m2max-m2min+eps, 1) >= eps+eps)
-       return 4;
-
-    // Check error condition 5.
-    if(m2min >= m2max+eps)
-        return 5;
-
-    // Only report m2min and m2max.
-    if(!thrcof)
-        return 0;
-
-    // Number of coefficients to compute.
-    nfin = m2max-m2min+1+eps;
-
-    // Check error condition 6.
-    if(ndim < nfin)
-        return 6;
+    WIGNER_STATS_ADD(WIGNER_STATS_3JM, calls, 1);
+    WIGNER_STATS_ADD(WIGNER_STATS_3JM, coefs, nfin);
 
     // Check whether m2 can take only one value, ie. m2min = m2max.
     if(m2min >= m2max-eps)
     {
         thrcof[0] = phase(fabs(l2-l3-m1)+eps)/sqrt(l1+l2+l3+1);
-        return 0;
+        return;
     }
 
     // This is reached in case that m2 and m3 take more than one value,
@@ -253,13 +246,17 @@ int wigner_3jm(double l1, double l2, double l3, double m1, double* m2min_out,
                 for(i = 0; i < lstep; ++i)
                 {
                     if(fabs(thrcof[i]) < srtiny)
+                    {
                         thrcof[i] = 0;
+                        WIGNER_STATS_ADD(WIGNER_STATS_3JM, zeroed, 1);
+                    }
                     else
                         thrcof[i] = thrcof[i] / srhuge;
                 }
                 sum1 = sum1 / huge;
                 sumfor = sumfor / huge;
                 x = x / srhuge;
+                WIGNER_STATS_ADD(WIGNER_STATS_3JM, rescales, 1);
             }
 
             // As long as abs(c1) is decreasing, the recursion proceeds towards
@@ -271,6 +268,8 @@ int wigner_3jm(double l1, double l2, double l3, double m1, double* m2min_out,
         }
     }
 
+    WIGNER_STATS_ADD(WIGNER_STATS_3JM, fwd_steps, lstep-1);
+
     // Keep three 3j coefficients around mmatch for comparison later
     // with backward recursion values.
     x1 = x;
@@ -338,16 +337,22 @@ int wigner_3jm(double l1, double l2, double l3, double m1, double* m2min_out,
                 {
                     index = nfin - i;
                     if(fabs(thrcof[index]) < srtiny)
+                    {
                         thrcof[index] = 0;
+                        WIGNER_STATS_ADD(WIGNER_STATS_3JM, zeroed, 1);
+                    }
                     else
                         thrcof[index] = thrcof[index] / srhuge;
                 }
                 sum2 = sum2 / huge;
                 sumbac = sumbac / huge;
+                WIGNER_STATS_ADD(WIGNER_STATS_3JM, rescales, 1);
             }
         }
     }
 
+    WIGNER_STATS_ADD(WIGNER_STATS_3JM, bwd_steps, lstep-1);
+
     // The forward recursion 3j coefficients x1, x2, x3 are to be matched
     // with the corresponding backward recursion values y1, y2, y3.
     y3 = y;
@@ -376,6 +381,8 @@ int wigner_3jm(double l1, double l2, double l3, double m1, double* m2min_out,
     goto norm;
 
     nobac:
+    WIGNER_STATS_ADD(WIGNER_STATS_3JM, fwd_steps, 1);
+    WIGNER_STATS_ADD(WIGNER_STATS_3JM, nobac, 1);
     sumuni = sum1;
 
     // Normalize 3j coefficients
@@ -394,7 +401,10 @@ int wigner_3jm(double l1, double l2, double l3, double m1, double* m2min_out,
         for(n = 0; n < nfin; ++n)
         {
             if(fabs(thrcof[n]) < thresh)
+            {
                 thrcof[n] = 0;
+                WIGNER_STATS_ADD(WIGNER_STATS_3JM, zeroed, 1);
+            }
             else
                 thrcof[n] = cnorm * thrcof[n];
         }
@@ -404,6 +414,210 @@ int wigner_3jm(double l1, double l2, double l3, double m1, double* m2min_out,
         for(n = 0; n < nfin; ++n)
             thrcof[n] = cnorm * thrcof[n];
     }
-    
+}
+
+int wigner_3jm(double l1, double l2, double l3, double m1, double* m2min_out,
+               double* m2max_out, double* thrcof, int ndim)
+{
+    // variables
+    int nfin;
+    double m2min, m2max;
+
+    // constants
+    const double eps = .01;
+
+    // Check error condition 1.
+    if((l1-fabs(m1)+eps < 0) || (fmod(l1+fabs(m1)+eps, 1) >= eps+eps))
+        return 1;
+
+    // Check error condition 2.
+    if((l1+l2-l3 < -eps) || (l1-l2+l3 < -eps) || (-l1+l2+l3 < -eps))
+       return 2;
+
+    // Check error condition 3.
+    if(fmod(l1+l2+l3+eps, 1) >= eps+eps)
+        return 3;
+
+    // Limits for m2
+    *m2min_out = m2min = fmax(-l2, -l3-m1);
+    *m2max_out = m2max = fmin(l2, l3-m1);
+
+    // Check error condition 4.
+    if(fmod(m2max-m2min+eps, 1) >= eps+eps)
+       return 4;
+
+    // Check error condition 5.
+    if(m2min >= m2max+eps)
+        return 5;
+
+    // Only report m2min and m2max.
+    if(!thrcof)
+        return 0;
+
+    // Number of coefficients to compute.
+    nfin = m2max-m2min+1+eps;
+
+    // Check error condition 6.
+    if(ndim < nfin)
+        return 6;
+
+    wigner_3jm_rec(l1, l2, l3, m1, m2min, m2max, nfin, thrcof);
+
+    return 0;
+}
+
+int wigner_3jm_int(int l1, int l2, int l3, int m1, int* m2min_out,
+                   int* m2max_out, double* thrcof, int ndim)
+{
+    // variables
+    int m2min, m2max, nfin;
+
+    // Check error condition 1.
+    if(l1 < abs(m1))
+        return 1;
+
+    // Check error condition 2.  Error conditions 3 and 4 cannot occur for
+    // integer arguments.
+    if((l1+l2-l3 < 0) || (l1-l2+l3 < 0) || (-l1+l2+l3 < 0))
+       return 2;
+
+    // Limits for m2
+    *m2min_out = m2min = imax(-l2, -l3-m1);
+    *m2max_out = m2max = imin(l2, l3-m1);
+
+    // Check error condition 5.
+    if(m2min > m2max)
+        return 5;
+
+    // Only report m2min and m2max.
+    if(!thrcof)
+        return 0;
+
+    // Number of coefficients to compute.
+    nfin = m2max-m2min+1;
+
+    // Check error condition 6.
+    if(ndim < nfin)
+        return 6;
+
+    wigner_3jm_rec(l1, l2, l3, m1, m2min, m2max, nfin, thrcof);
+
+    return 0;
+}
+
+int wigner_3jm_twoj(int two_l1, int two_l2, int two_l3, int two_m1,
+                    int* two_m2min_out, int* two_m2max_out, double* thrcof,
+                    int ndim)
+{
+    // variables
+    int two_m2min, two_m2max, nfin;
+
+    // Check error condition 1.
+    if((two_l1 < abs(two_m1)) || ((two_l1+two_m1)&1))
+        return 1;
+
+    // Check error condition 2.
+    if((two_l1+two_l2-two_l3 < 0) || (two_l1-two_l2+two_l3 < 0)
+            || (-two_l1+two_l2+two_l3 < 0))
+       return 2;
+
+    // Check error condition 3.
+    if((two_l1+two_l2+two_l3)&1)
+        return 3;
+
+    // Limits for m2
+    *two_m2min_out = two_m2min = imax(-two_l2, -two_l3-two_m1);
+    *two_m2max_out = two_m2max = imin(two_l2, two_l3-two_m1);
+
+    // Check error condition 4.
+    if((two_m2max-two_m2min)&1)
+       return 4;
+
+    // Check error condition 5.
+    if(two_m2min > two_m2max)
+        return 5;
+
+    // Only report m2min and m2max.
+    if(!thrcof)
+        return 0;
+
+    // Number of coefficients to compute.
+    nfin = (two_m2max-two_m2min)/2+1;
+
+    // Check error condition 6.
+    if(ndim < nfin)
+        return 6;
+
+    wigner_3jm_rec(0.5*two_l1, 0.5*two_l2, 0.5*two_l3, 0.5*two_m1,
+                   0.5*two_m2min, 0.5*two_m2max, nfin, thrcof);
+
+    return 0;
+}
+
+int wigner_3j_block(int l1, int l2, int l3, double* out)
+{
+    // variables
+    int m1, m2, m2min, m2max, nrow;
+    double sign;
+    double* row;
+    double* rev;
+
+    // Check the triangle condition, as in error condition 2 of wigner_3jm.
+    if((l1+l2-l3 < 0) || (l1-l2+l3 < 0) || (-l1+l2+l3 < 0))
+       return 2;
+
+    nrow = 2*l2+1;
+
+    // Rows for m1 >= 0 from the recursion in m2, each of which is stored
+    // directly into its slice of the output.
+    for(m1 = 0; m1 <= l1; ++m1)
+    {
+        row = out + (l1+m1)*nrow;
+        m2min = imax(-l2, -l3-m1);
+        m2max = imin(l2, l3-m1);
+        for(m2 = -l2; m2 < m2min; ++m2)
+            row[l2+m2] = 0;
+        wigner_3jm_rec(l1, l2, l3, m1, m2min, m2max, m2max-m2min+1,
+                       row + l2+m2min);
+        for(m2 = m2max+1; m2 <= l2; ++m2)
+            row[l2+m2] = 0;
+    }
+
+    // Rows for m1 < 0 from the symmetry under (m1, m2) -> (-m1, -m2).
+    sign = phase(l1+l2+l3);
+    for(m1 = 1; m1 <= l1; ++m1)
+    {
+        row = out + (l1-m1)*nrow;
+        rev = out + (l1+m1)*nrow;
+        for(m2 = -l2; m2 <= l2; ++m2)
+            row[l2+m2] = sign*rev[l2-m2];
+    }
+
+    return 0;
+}
+
+int clebsch_gordan_block(int l1, int l2, int l3, double* out)
+{
+    // variables
+    int ier, m1, m2, nrow;
+    double norm;
+    double* row;
+
+    ier = wigner_3j_block(l1, l2, l3, out);
+    if(ier)
+        return ier;
+
+    // <l1 m1 l2 m2|l3 m1+m2> = (-1)^(l1-l2+m1+m2) sqrt(2*l3+1)
+    //                          (l1 l2     l3   )
+    //                          (m1 m2 -(m1+m2) )
+    nrow = 2*l2+1;
+    norm = sqrt(l3+l3+1);
+    for(m1 = -l1; m1 <= l1; ++m1)
+    {
+        row = out + (l1+m1)*nrow;
+        for(m2 = -l2; m2 <= l2; ++m2)
+            row[l2+m2] *= phase(abs(l1-l2+m1+m2))*norm;
+    }
+
     return 0;
 }
@@ -23,6 +23,16 @@
 // -----
 // int wigner_6j(double l2, double l3, double l4, double l5, double l6,
 //               double* l1min, double* l1max, double* sixcof, int ndim);
+// int wigner_6j_int(int l2, int l3, int l4, int l5, int l6, int* l1min,
+//                   int* l1max, double* sixcof, int ndim);
+// int wigner_6j_twoj(int two_l2, int two_l3, int two_l4, int two_l5,
+//                    int two_l6, int* two_l1min, int* two_l1max,
+//                    double* sixcof, int ndim);
+//
+// The `_int` variant takes integer arguments, and the `_twoj` variant takes
+// twice the (half-)integer arguments, as do its outputs `two_l1min` and
+// `two_l1max`.  Both check their arguments exactly in integer arithmetic and
+// return the same error flags, then run the same recursion.
 //
 // Arguments
 // ---------
@@ -127,23 +137,38 @@
 // 22 Jun 2025  Translation to C by N. Tessore.
 //
 
+#include <stdlib.h>
 #include <math.h>
 #include <float.h>
 
+#include "wigner_stats.h"
+
 
 static inline double phase(int m) {
     return 1 - 2 * (m&1);
 }
 
 
-int wigner_6j(double l2, double l3, double l4, double l5, double l6,
-              double* l1min_out, double* l1max_out, double* sixcof, int ndim) {
+static inline int imin(int a, int b) {
+    return a < b ? a : b;
+}
+
+
+static inline int imax(int a, int b) {
+    return a > b ? a : b;
+}
+
+
+// Recursion for the 6j coefficients once the arguments have been checked.
+static void wigner_6j_rec(double l2, double l3, double l4, double l5,
+                          double l6, double l1min, double l1max, int nfin,
+                          double* sixcof) {
 
     // variables
-    int i, index, lstep, n, nfin, nfinp1, nfinp2, nfinp3, nlim, nstep2;
-    double a1, a1s, a2, a2s, c1, c1old, c2, cnorm, denom, dv, l1, l1min, l1max,
-           newfac, oldfac, ratio, sign1, sign2, sum1, sum2, sumbac, sumfor,
-           sumuni, thresh, x, x1, x2, x3, y, y1, y2, y3;
+    int i, index, lstep, n, nfinp1, nfinp2, nlim, nstep2;
+    double a1, a1s, a2, a2s, c1, c1old, c2, cnorm, denom, dv, l1, newfac,
+           oldfac, ratio, sign1, sign2, sum1, sum2, sumbac, sumfor, sumuni,
+           thresh, x, x1, x2, x3, y, y1, y2, y3;
 
     // constants
     const double eps = .01;
@@ -155,42 +180,13 @@ int wigner_6j(double l2, double l3, double l4, double l5, double l6,
     const double tiny = 1.0/huge;
     const double srtiny = 1.0/srhuge;
 
-    // Check error conditions 1, 2, and 3.
-    if ((fmod(l2+l3+l5+l6+eps, 1.0) >= eps+eps)
-            || (fmod(l4+l2+l6+eps, 1.0) >= eps+eps))
-        return 1;
-    if ((l4+l2-l6 < 0.0) || (l4-l2+l6 < 0.0) || (-l4+l2+l6 < 0.0))
-        return 2;
-    if ((l4-l5+l3 < 0.0) || (l4+l5-l3 < 0.0) || (-l4+l5+l3 < 0.0))
-        return 3;
-
-    // Limits for l1
-    *l1min_out = l1min = fmax(fabs(l2-l3), fabs(l5-l6));
-    *l1max_out = l1max = fmin(l2+l3, l5+l6);
-
-    // Check error condition 4.
-    if (fmod(l1max-l1min+eps, 1.0) >= eps+eps)
-        return 4;
-
-    // Check error condition 5.
-    if (l1min >= l1max+eps)
-        return 5;
-
-    // Only report l1min and l1max.
-    if(!sixcof)
-        return 0;
-
-    // Number of coefficients to compute.
-    nfin = l1max-l1min+1+eps;
-
-    // Check error condition 6.
-    if (ndim < nfin)
-        return 6;
+    WIGNER_STATS_ADD(WIGNER_STATS_6J, calls, 1);
+    WIGNER_STATS_ADD(WIGNER_STATS_6J, coefs, nfin);
 
     // Check whether l1 can take only one value, ie. l1min = l1max.
     if (l1min >= l1max-eps) {
         sixcof[0] = phase(l2+l3+l5+l6+eps) / sqrt((l1min+l1min+1)*(l4+l4+1));
-        return 0;
+        return;
     }
 
     // This is reached in case that L1 can take more than one value,
@@ -255,14 +251,16 @@ int wigner_6j(double l2, double l3, double l4, double l5, double l6,
                 // so that the recursion series sixcof[0], ..., sixcof[lstep-1]
                 // has to be rescaled to prevent overflow
                 for (i = 0; i < lstep; ++i) {
-                    if (fabs(sixcof[i]) < srtiny)
+                    if (fabs(sixcof[i]) < srtiny) {
                         sixcof[i] = 0.0;
-                    else
+                        WIGNER_STATS_ADD(WIGNER_STATS_6J, zeroed, 1);
+                    } else
                         sixcof[i] = sixcof[i] / srhuge;
                 }
                 sum1 = sum1 / huge;
                 sumfor = sumfor / huge;
                 x = x / srhuge;
+                WIGNER_STATS_ADD(WIGNER_STATS_6J, rescales, 1);
             }
 
             // As long as the coefficient abs(c1) is decreasing, the recursion
@@ -274,6 +272,8 @@ int wigner_6j(double l2, double l3, double l4, double l5, double l6,
         }
     }
 
+    WIGNER_STATS_ADD(WIGNER_STATS_6J, fwd_steps, lstep-1);
+
     // Keep three 6j coefficients around the match point for comparison later
     // with backward recursion.
     x1 = x;
@@ -337,17 +337,21 @@ int wigner_6j(double l2, double l3, double l4, double l5, double l6,
                 // sixcof[nfin-lstep] has to be rescaled to prevent overflow
                 for (i = 1; i <= lstep; ++i) {
                     index = nfin - i;
-                    if (fabs(sixcof[index]) < srtiny)
+                    if (fabs(sixcof[index]) < srtiny) {
                         sixcof[index] = 0.0;
-                    else
+                        WIGNER_STATS_ADD(WIGNER_STATS_6J, zeroed, 1);
+                    } else
                         sixcof[index] = sixcof[index] / srhuge;
                 }
                 sumbac = sumbac / huge;
                 sum2 = sum2 / huge;
+                WIGNER_STATS_ADD(WIGNER_STATS_6J, rescales, 1);
             }
         }
     }
 
+    WIGNER_STATS_ADD(WIGNER_STATS_6J, bwd_steps, lstep-1);
+
     // The forward recursion 6j coefficients x1, x2, x3 are to be matched
     // with the corresponding backward recursion values y1, y2, y3.
     y3 = y;
@@ -373,6 +377,8 @@ int wigner_6j(double l2, double l3, double l4, double l5, double l6,
     goto norm;
 
 nobac:
+    WIGNER_STATS_ADD(WIGNER_STATS_6J, fwd_steps, 1);
+    WIGNER_STATS_ADD(WIGNER_STATS_6J, nobac, 1);
     sumuni = sum1;
 
     // Normalize 6j coefficients
@@ -391,12 +397,144 @@ norm:
     } else {
         thresh = tiny / fabs(cnorm);
         for (n = 0; n < nfin; ++n) {
-            if (fabs(sixcof[n]) < thresh)
+            if (fabs(sixcof[n]) < thresh) {
                 sixcof[n] = 0.0;
-            else
+                WIGNER_STATS_ADD(WIGNER_STATS_6J, zeroed, 1);
+            } else
                 sixcof[n] = cnorm * sixcof[n];
         }
     }
+}
+
+
+int wigner_6j(double l2, double l3, double l4, double l5, double l6,
+              double* l1min_out, double* l1max_out, double* sixcof, int ndim) {
+
+    // variables
+    int nfin;
+    double l1min, l1max;
+
+    // constants
+    const double eps = .01;
+
+    // Check error conditions 1, 2, and 3.
+    if ((fmod(l2+l3+l5+l6+eps, 1.0) >= eps+eps)
+            || (fmod(l4+l2+l6+eps, 1.0) >= eps+eps))
+        return 1;
+    if ((l4+l2-l6 < 0.0) || (l4-l2+l6 < 0.0) || (-l4+l2+l6 < 0.0))
+        return 2;
+    if ((l4-l5+l3 < 0.0) || (l4+l5-l3 < 0.0) || (-l4+l5+l3 < 0.0))
+        return 3;
+
+    // Limits for l1
+    *l1min_out = l1min = fmax(fabs(l2-l3), fabs(l5-l6));
+    *l1max_out = l1max = fmin(l2+l3, l5+l6);
+
+    // Check error condition 4.
+    if (fmod(l1max-l1min+eps, 1.0) >= eps+eps)
+        return 4;
+
+    // Check error condition 5.
+    if (l1min >= l1max+eps)
+        return 5;
+
+    // Only report l1min and l1max.
+    if(!sixcof)
+        return 0;
+
+    // Number of coefficients to compute.
+    nfin = l1max-l1min+1+eps;
+
+    // Check error condition 6.
+    if (ndim < nfin)
+        return 6;
+
+    wigner_6j_rec(l2, l3, l4, l5, l6, l1min, l1max, nfin, sixcof);
+
+    return 0;
+}
+
+
+int wigner_6j_int(int l2, int l3, int l4, int l5, int l6, int* l1min_out,
+                  int* l1max_out, double* sixcof, int ndim) {
+
+    // variables
+    int l1min, l1max, nfin;
+
+    // Check error conditions 2 and 3.  Error conditions 1 and 4 cannot occur
+    // for integer arguments.
+    if ((l4+l2-l6 < 0) || (l4-l2+l6 < 0) || (-l4+l2+l6 < 0))
+        return 2;
+    if ((l4-l5+l3 < 0) || (l4+l5-l3 < 0) || (-l4+l5+l3 < 0))
+        return 3;
+
+    // Limits for l1
+    *l1min_out = l1min = imax(abs(l2-l3), abs(l5-l6));
+    *l1max_out = l1max = imin(l2+l3, l5+l6);
+
+    // Check error condition 5.
+    if (l1min > l1max)
+        return 5;
+
+    // Only report l1min and l1max.
+    if(!sixcof)
+        return 0;
+
+    // Number of coefficients to compute.
+    nfin = l1max-l1min+1;
+
+    // Check error condition 6.
+    if (ndim < nfin)
+        return 6;
+
+    wigner_6j_rec(l2, l3, l4, l5, l6, l1min, l1max, nfin, sixcof);
+
+    return 0;
+}
+
+
+int wigner_6j_twoj(int two_l2, int two_l3, int two_l4, int two_l5, int two_l6,
+                   int* two_l1min_out, int* two_l1max_out, double* sixcof,
+                   int ndim) {
+
+    // variables
+    int two_l1min, two_l1max, nfin;
+
+    // Check error conditions 1, 2, and 3.
+    if (((two_l2+two_l3+two_l5+two_l6)&1) || ((two_l4+two_l2+two_l6)&1))
+        return 1;
+    if ((two_l4+two_l2-two_l6 < 0) || (two_l4-two_l2+two_l6 < 0)
+            || (-two_l4+two_l2+two_l6 < 0))
+        return 2;
+    if ((two_l4-two_l5+two_l3 < 0) || (two_l4+two_l5-two_l3 < 0)
+            || (-two_l4+two_l5+two_l3 < 0))
+        return 3;
+
+    // Limits for l1
+    *two_l1min_out = two_l1min = imax(abs(two_l2-two_l3), abs(two_l5-two_l6));
+    *two_l1max_out = two_l1max = imin(two_l2+two_l3, two_l5+two_l6);
+
+    // Check error condition 4.
+    if ((two_l1max-two_l1min)&1)
+        return 4;
+
+    // Check error condition 5.
+    if (two_l1min > two_l1max)
+        return 5;
+
+    // Only report l1min and l1max.
+    if(!sixcof)
+        return 0;
+
+    // Number of coefficients to compute.
+    nfin = (two_l1max-two_l1min)/2+1;
+
+    // Check error condition 6.
+    if (ndim < nfin)
+        return 6;
+
+    wigner_6j_rec(0.5*two_l2, 0.5*two_l3, 0.5*two_l4, 0.5*two_l5, 0.5*two_l6,
+                  0.5*two_l1min, 0.5*two_l1max, nfin, sixcof);
 
     return 0;
 }
@@ -0,0 +1,301 @@
+// compute rows of 3j and 6j symbols and d functions for many arguments into
+// one buffer
+//
+// notes:
+// - rows are stored back to back in a caller-owned buffer, with the start of
+//   row i at offsets[i] and its end at offsets[i+1]
+// - the offsets follow from the limits of each row alone, so that they can
+//   be computed before any symbols, and rows can be filled in parallel
+// - rows are split into several tasks per thread of the execution context,
+//   with about the same number of coefficients each, so that long rows at
+//   large l do not leave threads idle; without a context, OpenMP is used
+//   with its default number of threads, if enabled
+
+#include <stddef.h>
+
+#include "wigner.h"
+
+// number of tasks per thread
+#ifndef BATCH_TASKS
+#define BATCH_TASKS 8
+#endif
+
+// largest number of tasks of a single call
+#define BATCH_MAXTASKS 1024
+
+// fixed cost of a row, in coefficients, when rows are split into tasks
+#ifndef BATCH_ROW_COST
+#define BATCH_ROW_COST 16
+#endif
+
+// arguments and results of a batch, shared by its tasks
+struct batch
+{
+    int n, ntasks;
+    const double* a[5];
+    const size_t* offsets;
+    double* l1min;
+    double* out;
+    int* ier;
+    int nerr[BATCH_MAXTASKS];
+};
+
+static int batch_ntasks(int n, const struct wigner_exec* exec)
+{
+    int nthreads, ntasks;
+
+    nthreads = wigner_exec_threads(exec);
+    if(nthreads < 2)
+        return n < 1 ? n : 1;
+
+    ntasks = BATCH_TASKS*nthreads;
+    if(ntasks > BATCH_MAXTASKS)
+        ntasks = BATCH_MAXTASKS;
+    if(ntasks > n)
+        ntasks = n;
+
+    return ntasks;
+}
+
+// first row whose cost offsets[i] + BATCH_ROW_COST*i is at least c
+static int batch_find(const struct batch* b, double c)
+{
+    int lo, hi, mid;
+
+    lo = 0;
+    hi = b->n;
+    while(lo < hi)
+    {
+        mid = lo + (hi-lo)/2;
+        if((double)b->offsets[mid] + (double)BATCH_ROW_COST*mid < c)
+            lo = mid+1;
+        else
+            hi = mid;
+    }
+
+    return lo;
+}
+
+// rows of a task, such that all tasks have about the same cost
+static void batch_range(const struct batch* b, int task, int* begin,
+                        int* end)
+{
+    double total;
+
+    total = (double)b->offsets[b->n] + (double)BATCH_ROW_COST*b->n;
+    *begin = batch_find(b, total*task/b->ntasks);
+    *end = task+1 < b->ntasks ? batch_find(b, total*(task+1)/b->ntasks)
+                              : b->n;
+}
+
+static int batch_nerr(const struct batch* b)
+{
+    int i, nerr;
+
+    nerr = 0;
+    for(i = 0; i < b->ntasks; ++i)
+        nerr += b->nerr[i];
+
+    return nerr;
+}
+
+size_t wigner_3jj_batch_size(int n, const double* l2, const double* l3,
+                             const double* m2, const double* m3,
+                             size_t* offsets)
+{
+    int i;
+    double l1min, l1max;
+
+    offsets[0] = 0;
+    for(i = 0; i < n; ++i)
+    {
+        offsets[i+1] = offsets[i];
+        if(!wigner_3jj(l2[i], l3[i], m2[i], m3[i], &l1min, &l1max, NULL, 0))
+            offsets[i+1] += (size_t)(l1max-l1min+1.01);
+    }
+
+    return offsets[n];
+}
+
+static void task_3jj(void* arg, int task)
+{
+    struct batch* b = arg;
+    int i, begin, end, e, nerr;
+    double lmin, lmax;
+
+    batch_range(b, task, &begin, &end);
+
+    nerr = 0;
+    for(i = begin; i < end; ++i)
+    {
+        // zero for rows that fail before the limits are known
+        lmin = lmax = 0;
+        e = wigner_3jj(b->a[0][i], b->a[1][i], b->a[2][i], b->a[3][i],
+                       &lmin, &lmax, b->out + b->offsets[i],
+                       (int)(b->offsets[i+1]-b->offsets[i]));
+        if(b->l1min)
+            b->l1min[i] = lmin;
+        if(b->ier)
+            b->ier[i] = e;
+        if(e)
+            nerr += 1;
+    }
+
+    b->nerr[task] = nerr;
+}
+
+int wigner_3jj_batch_exec(int n, const double* l2, const double* l3,
+                          const double* m2, const double* m3,
+                          const size_t* offsets, double* l1min,
+                          double* thrcof, int* ier,
+                          const struct wigner_exec* exec)
+{
+    struct batch b;
+
+    b.n = n;
+    b.ntasks = batch_ntasks(n, exec);
+    b.a[0] = l2;
+    b.a[1] = l3;
+    b.a[2] = m2;
+    b.a[3] = m3;
+    b.offsets = offsets;
+    b.l1min = l1min;
+    b.out = thrcof;
+    b.ier = ier;
+
+    wigner_exec_run(exec, b.ntasks, task_3jj, &b);
+
+    return batch_nerr(&b);
+}
+
+int wigner_3jj_batch(int n, const double* l2, const double* l3,
+                     const double* m2, const double* m3,
+                     const size_t* offsets, double* l1min, double* thrcof,
+                     int* ier)
+{
+    return wigner_3jj_batch_exec(n, l2, l3, m2, m3, offsets, l1min, thrcof,
+                                 ier, NULL);
+}
+
+size_t wigner_6j_batch_size(int n, const double* l2, const double* l3,
+                            const double* l4, const double* l5,
+                            const double* l6, size_t* offsets)
+{
+    int i;
+    double l1min, l1max;
+
+    offsets[0] = 0;
+    for(i = 0; i < n; ++i)
+    {
+        offsets[i+1] = offsets[i];
+        if(!wigner_6j(l2[i], l3[i], l4[i], l5[i], l6[i], &l1min, &l1max,
+                      NULL, 0))
+            offsets[i+1] += (size_t)(l1max-l1min+1.01);
+    }
+
+    return offsets[n];
+}
+
+static void task_6j(void* arg, int task)
+{
+    struct batch* b = arg;
+    int i, begin, end, e, nerr;
+    double lmin, lmax;
+
+    batch_range(b, task, &begin, &end);
+
+    nerr = 0;
+    for(i = begin; i < end; ++i)
+    {
+        // zero for rows that fail before the limits are known
+        lmin = lmax = 0;
+        e = wigner_6j(b->a[0][i], b->a[1][i], b->a[2][i], b->a[3][i],
+                      b->a[4][i], &lmin, &lmax, b->out + b->offsets[i],
+                      (int)(b->offsets[i+1]-b->offsets[i]));
+        if(b->l1min)
+            b->l1min[i] = lmin;
+        if(b->ier)
+            b->ier[i] = e;
+        if(e)
+            nerr += 1;
+    }
+
+    b->nerr[task] = nerr;
+}
+
+int wigner_6j_batch_exec(int n, const double* l2, const double* l3,
+                         const double* l4, const double* l5,
+                         const double* l6, const size_t* offsets,
+                         double* l1min, double* sixcof, int* ier,
+                         const struct wigner_exec* exec)
+{
+    struct batch b;
+
+    b.n = n;
+    b.ntasks = batch_ntasks(n, exec);
+    b.a[0] = l2;
+    b.a[1] = l3;
+    b.a[2] = l4;
+    b.a[3] = l5;
+    b.a[4] = l6;
+    b.offsets = offsets;
+    b.l1min = l1min;
+    b.out = sixcof;
+    b.ier = ier;
+
+    wigner_exec_run(exec, b.ntasks, task_6j, &b);
+
+    return batch_nerr(&b);
+}
+
+int wigner_6j_batch(int n, const double* l2, const double* l3,
+                    const double* l4, const double* l5, const double* l6,
+                    const size_t* offsets, double* l1min, double* sixcof,
+                    int* ier)
+{
+    return wigner_6j_batch_exec(n, l2, l3, l4, l5, l6, offsets, l1min,
+                                sixcof, ier, NULL);
+}
+
+// arguments of a batch of d functions, shared by its tasks
+struct batch_dl
+{
+    int lmin, lmax, m1, m2, n, ntasks;
+    const double* theta;
+    double* d;
+};
+
+static void task_dl(void* arg, int task)
+{
+    struct batch_dl* b = arg;
+    int i, begin, end;
+    size_t nl;
+
+    nl = (size_t)(b->lmax - b->lmin + 1);
+    begin = (int)((long long)b->n*task/b->ntasks);
+    end = (int)((long long)b->n*(task+1)/b->ntasks);
+
+    for(i = begin; i < end; ++i)
+        wigner_dl(b->lmin, b->lmax, b->m1, b->m2, b->theta[i], b->d + i*nl);
+}
+
+void wigner_dl_batch(int lmin, int lmax, int m1, int m2, int n,
+                     const double* theta, double* d,
+                     const struct wigner_exec* exec)
+{
+    struct batch_dl b;
+
+    if(lmax < lmin)
+        return;
+
+    b.lmin = lmin;
+    b.lmax = lmax;
+    b.m1 = m1;
+    b.m2 = m2;
+    b.n = n;
+    b.ntasks = batch_ntasks(n, exec);
+    b.theta = theta;
+    b.d = d;
+
+    wigner_exec_run(exec, b.ntasks, task_dl, &b);
+}
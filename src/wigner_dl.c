@@ -5,9 +5,19 @@
 // notes:
 // - uses SSE intrinsics by default if SSE3 is detected; compile with -DNO_SSE
 //   to disable
+// - the common spin pairs with abs(m1) = abs(m2) and with one spin zero, for
+//   spins 1, 2, 4, use specialised recurrences with the coefficients resolved
+//   at compile time; compile with -DNO_DL_KERNELS to disable
+// - wigner_dl_multi runs the recurrences for several spin pairs side by side
+//   in DL_LANES lanes, sharing all terms that depend only on l
+// - wigner_dl_segmented splits a long row into segments, which are computed
+//   in parallel on the execution context, or with OpenMP if enabled
 
 #include <stdlib.h>
 #include <math.h>
+#include <float.h>
+
+#include "wigner.h"
 
 #ifndef NO_SSE
 #ifdef __SSE3__
@@ -16,26 +26,36 @@
 #endif
 #endif
 
-static inline int binom(int n, int k)
+// binomial coefficient in floating point, exact as long as it fits
+static inline double binom(int n, int k)
 {
-    int b, i;
+    double b;
+    int i;
     
     if(k > n/2)
         k = n-k;
     
     b = 1;
     for(i = 1; i <= k; ++i, --n)
-    {
-        if(n%i == 0)
-            b = (n/i)*b;
-        else if(b%i == 0)
-            b = (b/i)*n;
-        else
-            b = (n*b)/i;
-    }
+        b = b*n/i;
     return b;
 }
 
+// starting value (-1)^c sqrt(binom(a+b, a)) u^a v^b of the recurrences, with
+// logarithms for large spins where the binomial coefficient overflows
+static inline double dl_start(int a, int b, int c, double u, double v)
+{
+    double f;
+    
+    f = sqrt(binom(a+b, a));
+    if(f <= DBL_MAX)
+        f *= pow(u, a)*pow(v, b);
+    else
+        f = exp(0.5*(lgamma(a+b+1.) - lgamma(a+1.) - lgamma(b+1.))
+                + a*log(u) + b*log(v));
+    return (1 - 2*(c&1))*f;
+}
+
 void legendre_pl(int lmin, int lmax, double x, double* p)
 {
     int l;
@@ -54,6 +74,74 @@ void legendre_pl(int lmin, int lmax, double x, double* p)
         p[l-lmin] = ((2*l-1)*x*p[l-1-lmin] - (l-1)*p[l-2-lmin])/l;
 }
 
+#ifndef NO_DL_KERNELS
+
+// recurrence d_l = [(2l-1) (l(l-1) x - J) d_{l-1} - l s_{l-1} d_{l-2}] /
+//                   [(l-1) s_l]
+// with J = n*m and s_l = sqrt((l^2-n^2) (l^2-m^2)) given as an expression S in
+// the double L = l, so that |n| = |m| needs no square root, starting from
+// d_lp = d0 where s_lp = 0; the coefficients do not depend on d, which keeps
+// the division off the dependency chain of the recurrence
+#define DL_KERNEL(name, J, S)                                               \
+static void name(int l0, int l1, int lp, double x, double d0, double* d)   \
+{                                                                           \
+    int l;                                                                  \
+    double L, d1 = 0, d2, s0, s1 = 0, r;                                    \
+    for(l = lp+1; l <= l1; ++l)                                             \
+    {                                                                       \
+        L = l;                                                              \
+        s0 = S;                                                             \
+        r = 1/((L-1)*s0);                                                   \
+        d2 = d1;                                                            \
+        d1 = d0;                                                            \
+        d0 = (2*L-1)*(L*(L-1)*x - J)*r*d1 - L*s1*r*d2;                      \
+        s1 = s0;                                                            \
+        if(l >= l0)                                                         \
+            *(d++) = d0;                                                    \
+    }                                                                       \
+}
+
+DL_KERNEL(dl_rec_1p1, 1, L*L-1)
+DL_KERNEL(dl_rec_1m1, -1, L*L-1)
+DL_KERNEL(dl_rec_2p2, 4, L*L-4)
+DL_KERNEL(dl_rec_2m2, -4, L*L-4)
+DL_KERNEL(dl_rec_4p4, 16, L*L-16)
+DL_KERNEL(dl_rec_4m4, -16, L*L-16)
+DL_KERNEL(dl_rec_0x1, 0, L*sqrt(L*L-1))
+DL_KERNEL(dl_rec_0x2, 0, L*sqrt(L*L-4))
+DL_KERNEL(dl_rec_0x4, 0, L*sqrt(L*L-16))
+
+typedef void dl_rec(int l0, int l1, int lp, double x, double d0, double* d);
+
+// specialised recurrence for the spins n, m, or NULL if there is none
+static dl_rec* dl_kernel(int n, int m)
+{
+    if(n == m || n == -m)
+    {
+        switch(n*m)
+        {
+            case 1: return dl_rec_1p1;
+            case -1: return dl_rec_1m1;
+            case 4: return dl_rec_2p2;
+            case -4: return dl_rec_2m2;
+            case 16: return dl_rec_4p4;
+            case -16: return dl_rec_4m4;
+        }
+    }
+    else if(n == 0 || m == 0)
+    {
+        switch(n*n + m*m)
+        {
+            case 1: return dl_rec_0x1;
+            case 4: return dl_rec_0x2;
+            case 16: return dl_rec_0x4;
+        }
+    }
+    return NULL;
+}
+
+#endif
+
 void wigner_dl(int l0, int l1, int n, int m, double theta, double* d)
 {
     double d0, u, v, x;
@@ -64,6 +152,9 @@ void wigner_dl(int l0, int l1, int n, int m, double theta, double* d)
 #else
     __m128d o, j, z, r, s, t;
 #endif
+#ifndef NO_DL_KERNELS
+    dl_rec* rec;
+#endif
     
     if(n == 0 && m == 0)
     {
@@ -90,7 +181,20 @@ void wigner_dl(int l0, int l1, int n, int m, double theta, double* d)
     v = cos(0.5*theta);
     x = v*v - u*u;
     
-    d0 = (1 - 2*(c&1))*sqrt(binom(a+b, a))*pow(u, a)*pow(v, b);
+    d0 = dl_start(a, b, c, u, v);
+    
+#ifndef NO_DL_KERNELS
+    rec = dl_kernel(n, m);
+    if(rec)
+    {
+        for(l = l0; l < lp && l <= l1; ++l)
+            *(d++) = 0;
+        if(l == lp && lp <= l1)
+            *(d++) = d0;
+        rec(l0, l1, lp, x, d0, d);
+        return;
+    }
+#endif
     
 #ifndef USE_SSE
     d1 = 0;
@@ -102,9 +206,9 @@ void wigner_dl(int l0, int l1, int n, int m, double theta, double* d)
     z = _mm_set_pd(1, -n*m);
 #endif
     
-    for(l = l0; l < lp; ++l)
+    for(l = l0; l < lp && l <= l1; ++l)
         *(d++) = 0;
-    if(l == lp)
+    if(l == lp && lp <= l1)
         *(d++) = d0;
     for(l = lp+1; l <= l1; ++l)
     {
@@ -136,3 +240,515 @@ void wigner_dl(int l0, int l1, int n, int m, double theta, double* d)
 #endif
     }
 }
+
+// normalisation s_l = sqrt((l^2-n^2) (l^2-m^2)) of the recurrence, computed
+// as in the specialised kernels, without square root if abs(n) = abs(m)
+static inline double dl_norm(double L, int n, int m)
+{
+    if(n == m || n == -m)
+        return L*L - n*n;
+    if(n == 0 || m == 0)
+        return L*sqrt(L*L - (n*n + m*m));
+    return sqrt((L*L - n*n)*(L*L - m*m));
+}
+
+void wigner_dl_init(struct wigner_dl_state* s, int m1, int m2, double theta)
+{
+    int n = m1, m = m2, a, b, c;
+    double u, v;
+    
+    if(abs(n) > abs(m))
+    {
+        if(n > 0)
+            s->lp = n, a = n - m, b = n + m, c = n - m;
+        else
+            s->lp = -n, a = m - n, b = -n - m, c = 0;
+    }
+    else
+    {
+        if(m > 0)
+            s->lp = m, a = m - n, b = n + m, c = 0;
+        else
+            s->lp = -m, a = n - m, b = -n - m, c = n - m;
+    }
+    
+    u = sin(0.5*theta);
+    v = cos(0.5*theta);
+    
+    s->m1 = m1;
+    s->m2 = m2;
+    s->l = 0;
+    s->x = n == 0 && m == 0 ? cos(theta) : v*v - u*u;
+    s->dlp = dl_start(a, b, c, u, v);
+    s->d1 = 0;
+    s->d2 = 0;
+    s->s1 = 0;
+}
+
+void wigner_dl_advance(struct wigner_dl_state* s, int nl, double* d)
+{
+    int l, l1, n, m;
+    double L, x, r, d0, d1, d2, s0, s1;
+    
+    n = s->m1;
+    m = s->m2;
+    x = s->x;
+    l = s->l;
+    l1 = l + nl;
+    d1 = s->d1;
+    d2 = s->d2;
+    s1 = s->s1;
+    
+    // up to the starting value, and l = 1 of the Legendre polynomials
+    for(; l < l1 && l <= s->lp + (s->lp == 0); ++l)
+    {
+        d0 = l < s->lp ? 0 : l == s->lp ? s->dlp : x;
+        d2 = d1;
+        d1 = d0;
+        if(d)
+            *(d++) = d0;
+    }
+    
+    if(n == 0 && m == 0)
+    {
+        // the recurrence of legendre_pl
+        for(; l < l1; ++l)
+        {
+            d0 = ((2*l-1)*x*d1 - (l-1)*d2)/l;
+            d2 = d1;
+            d1 = d0;
+            if(d)
+                *(d++) = d0;
+        }
+    }
+    else
+    {
+        // the recurrence of the specialised wigner_dl kernels
+        for(; l < l1; ++l)
+        {
+            L = l;
+            s0 = dl_norm(L, n, m);
+            r = 1/((L-1)*s0);
+            d0 = (2*L-1)*(L*(L-1)*x - n*m)*r*d1 - L*s1*r*d2;
+            s1 = s0;
+            d2 = d1;
+            d1 = d0;
+            if(d)
+                *(d++) = d0;
+        }
+    }
+    
+    s->l = l;
+    s->d1 = d1;
+    s->d2 = d2;
+    s->s1 = s1;
+}
+
+// maximum number of segments, and minimum number of degrees per segment, of
+// wigner_dl_segmented
+#ifndef DL_SEGMENTS
+#define DL_SEGMENTS 256
+#endif
+#ifndef DL_SEGMENT_MIN
+#define DL_SEGMENT_MIN 8192
+#endif
+
+// advance the state up to degree lb, storing the values for l >= l0 in d
+static void dl_range(struct wigner_dl_state* s, int lb, int l0, double* d)
+{
+    if(s->l < l0)
+        wigner_dl_advance(s, (lb < l0 ? lb : l0) - s->l, NULL);
+    if(s->l < lb)
+        wigner_dl_advance(s, lb - s->l, d + (s->l - l0));
+}
+
+// transfer matrix t of the recurrence from the state over nl degrees, with
+// (d_{l+nl-1}, d_{l+nl-2}) = t (a, b) for (d_{l-1}, d_{l-2}) = (a+b, a-b),
+// computed by running the recurrence of wigner_dl_advance on (1, 1) and
+// (1, -1) at once; near theta = 0 and pi, where d_{l-1} and d_{l-2} are
+// almost equal, this basis is much better conditioned than the unit vectors
+static void dl_transfer(const struct wigner_dl_state* s, int nl, double* t)
+{
+    int l, l1, n, m;
+    double L, x, r, a, b, p0, p1, p2, q0, q1, q2, s0, s1;
+    
+    n = s->m1;
+    m = s->m2;
+    x = s->x;
+    l = s->l;
+    l1 = l + nl;
+    s1 = s->s1;
+    p1 = 1, p2 = 1;
+    q1 = 1, q2 = -1;
+    
+    if(n == 0 && m == 0)
+    {
+        for(; l < l1; ++l)
+        {
+            p0 = ((2*l-1)*x*p1 - (l-1)*p2)/l;
+            q0 = ((2*l-1)*x*q1 - (l-1)*q2)/l;
+            p2 = p1, p1 = p0;
+            q2 = q1, q1 = q0;
+        }
+    }
+    else
+    {
+        for(; l < l1; ++l)
+        {
+            L = l;
+            s0 = dl_norm(L, n, m);
+            r = 1/((L-1)*s0);
+            a = (2*L-1)*(L*(L-1)*x - n*m)*r;
+            b = L*s1*r;
+            s1 = s0;
+            p0 = a*p1 - b*p2;
+            q0 = a*q1 - b*q2;
+            p2 = p1, p1 = p0;
+            q2 = q1, q1 = q0;
+        }
+    }
+    
+    t[0] = p1, t[1] = q1;
+    t[2] = p2, t[3] = q2;
+}
+
+// segments of wigner_dl_segmented, shared by their tasks
+struct segments
+{
+    struct wigner_dl_state s;
+    int l0, l1, ls, bs, nb;
+    double* t;
+    const double* v;
+    double* d;
+};
+
+// transfer matrix of segment i
+static void transfer_task(void* arg, int i)
+{
+    const struct segments* g = arg;
+    struct wigner_dl_state sb;
+    
+    sb = g->s;
+    sb.l = g->ls + i*g->bs;
+    sb.s1 = dl_norm(sb.l-1, sb.m1, sb.m2);
+    dl_transfer(&sb, g->bs, g->t + 4*i);
+}
+
+// recurrence in segment i from its starting values
+static void segment_task(void* arg, int i)
+{
+    const struct segments* g = arg;
+    struct wigner_dl_state sb;
+    
+    sb = g->s;
+    sb.l = g->ls + i*g->bs;
+    sb.d1 = g->v[2*i+0];
+    sb.d2 = g->v[2*i+1];
+    sb.s1 = dl_norm(sb.l-1, sb.m1, sb.m2);
+    dl_range(&sb, i < g->nb-1 ? sb.l + g->bs : g->l1+1, g->l0, g->d);
+}
+
+void wigner_dl_segmented_exec(int l0, int l1, int m1, int m2, double theta,
+                              double* d, const struct wigner_exec* exec)
+{
+    int i, ls, nb;
+    struct segments g;
+    double a, b, t[4*DL_SEGMENTS], v[2*DL_SEGMENTS];
+    
+    wigner_dl_init(&g.s, m1, m2, theta);
+    
+    // serially up to the first degree of the recurrence proper
+    ls = g.s.lp + 1 + (g.s.lp == 0);
+    dl_range(&g.s, ls < l1+1 ? ls : l1+1, l0, d);
+    
+    nb = wigner_exec_threads(exec);
+    if(nb > DL_SEGMENTS)
+        nb = DL_SEGMENTS;
+    if(nb > (l1+1 - g.s.l)/DL_SEGMENT_MIN)
+        nb = (l1+1 - g.s.l)/DL_SEGMENT_MIN;
+    
+    if(nb < 2)
+    {
+        dl_range(&g.s, l1+1, l0, d);
+        return;
+    }
+    
+    // segment i covers degrees ls + i*bs up to ls + (i+1)*bs - 1
+    g.l0 = l0;
+    g.l1 = l1;
+    g.ls = g.s.l;
+    g.bs = (l1+1 - g.ls + nb-1)/nb;
+    g.nb = nb;
+    g.t = t;
+    g.v = v;
+    g.d = d;
+    
+    // transfer matrices of all segments but the last, in parallel
+    wigner_exec_run(exec, nb-1, transfer_task, &g);
+    
+    // starting values of all segments by a serial scan
+    v[0] = g.s.d1;
+    v[1] = g.s.d2;
+    for(i = 1; i < nb; ++i)
+    {
+        a = 0.5*(v[2*i-2] + v[2*i-1]);
+        b = 0.5*(v[2*i-2] - v[2*i-1]);
+        v[2*i+0] = t[4*i-4]*a + t[4*i-3]*b;
+        v[2*i+1] = t[4*i-2]*a + t[4*i-1]*b;
+    }
+    
+    // recurrence in each segment, in parallel
+    wigner_exec_run(exec, nb, segment_task, &g);
+}
+
+void wigner_dl_segmented(int l0, int l1, int m1, int m2, double theta,
+                         double* d)
+{
+    wigner_dl_segmented_exec(l0, l1, m1, m2, theta, d, NULL);
+}
+
+// number of spin pairs which wigner_dl_multi advances together
+#ifndef DL_LANES
+#define DL_LANES 4
+#endif
+
+void wigner_dl_multi(int l0, int l1, int nspin, const int* m1, const int* m2,
+                     double theta, int interleave, double* d)
+{
+    int i, k, l, n, m, nk, ls, a, b, c, h, nh;
+    int lp[DL_LANES], hn[DL_LANES], hm[DL_LANES];
+    double u, v, x, L, w, y, t, r, e, p, q;
+    double j[DL_LANES], nn[DL_LANES], mm[DL_LANES], kk[2*DL_LANES];
+    double sk[2*DL_LANES], rk[2*DL_LANES];
+    double d0[DL_LANES], d1[DL_LANES], d2[DL_LANES], s1[DL_LANES];
+    size_t dl, dk;
+    
+    u = sin(0.5*theta);
+    v = cos(0.5*theta);
+    x = v*v - u*u;
+    
+    // strides between degrees and between spin pairs in the output
+    if(interleave)
+        dl = nspin, dk = 1;
+    else
+        dl = 1, dk = l1 - l0 + 1;
+    
+    for(i = 0; i < nspin; i += DL_LANES)
+    {
+        nk = nspin - i < DL_LANES ? nspin - i : DL_LANES;
+        
+        // the recurrence is shared from the largest starting degree on; it
+        // is at least 2, so that l = 1 of d^l_{00} is never divided by l-1
+        ls = 1;
+        nh = 0;
+        for(k = 0; k < DL_LANES; ++k)
+        {
+            n = k < nk ? m1[i+k] : 0;
+            m = k < nk ? m2[i+k] : 0;
+            lp[k] = abs(n) > abs(m) ? abs(n) : abs(m);
+            if(lp[k] > ls)
+                ls = lp[k];
+            j[k] = n*m;
+            nn[k] = n*n;
+            mm[k] = m*m;
+            
+            // the distinct squared spins, since s_l = sqrt(l^2-n^2)
+            // sqrt(l^2-m^2) factorises into terms shared between spin pairs
+            for(h = 0; h < nh && kk[h] != nn[k]; ++h) {}
+            if(h == nh)
+                kk[nh++] = nn[k];
+            hn[k] = h;
+            for(h = 0; h < nh && kk[h] != mm[k]; ++h) {}
+            if(h == nh)
+                kk[nh++] = mm[k];
+            hm[k] = h;
+        }
+        
+        // each spin pair up to ls on its own, from its starting value
+        for(k = 0; k < DL_LANES; ++k)
+        {
+            n = k < nk ? m1[i+k] : 0;
+            m = k < nk ? m2[i+k] : 0;
+            
+            if(abs(n) > abs(m))
+            {
+                if(n > 0)
+                    a = n - m, b = n + m, c = n - m;
+                else
+                    a = m - n, b = -n - m, c = 0;
+            }
+            else
+            {
+                if(m > 0)
+                    a = m - n, b = n + m, c = 0;
+                else
+                    a = n - m, b = -n - m, c = n - m;
+            }
+            
+            d0[k] = d1[k] = s1[k] = 0;
+            for(l = 0; l <= ls; ++l)
+            {
+                L = l;
+                q = sqrt(fabs((L*L - nn[k])*(L*L - mm[k])));
+                if(l < lp[k])
+                    e = 0;
+                else if(l == lp[k])
+                    e = dl_start(a, b, c, u, v);
+                else if(l == 1)
+                    e = x;
+                else
+                    e = ((2*L-1)*(L*(L-1)*x - j[k])*d0[k] - L*s1[k]*d1[k])
+                                                                / ((L-1)*q);
+                d1[k] = d0[k];
+                d0[k] = e;
+                s1[k] = q;
+                if(k < nk && l >= l0 && l <= l1)
+                    d[(l-l0)*dl + (i+k)*dk] = e;
+            }
+        }
+        
+        // all spin pairs together, with the factors that depend only on l,
+        // and the square roots and reciprocals for each distinct spin,
+        // computed once, so that the loop over lanes has no divisions
+        for(l = ls+1; l <= l1; ++l)
+        {
+            L = l;
+            w = 2*L-1;
+            y = L*(L-1)*x;
+            t = 1/(L-1);
+            p = L*L;
+            for(h = 0; h < nh; ++h)
+            {
+                sk[h] = sqrt(p - kk[h]);
+                rk[h] = 1/sk[h];
+            }
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 8
+            #pragma GCC unroll 8
+#endif
+            for(k = 0; k < DL_LANES; ++k)
+            {
+                q = sk[hn[k]]*sk[hm[k]];
+                r = t*rk[hn[k]]*rk[hm[k]];
+                d2[k] = d1[k];
+                d1[k] = d0[k];
+                d0[k] = w*(y - j[k])*r*d1[k] - L*s1[k]*r*d2[k];
+                s1[k] = q;
+            }
+            if(l >= l0)
+                for(k = 0; k < nk; ++k)
+                    d[(l-l0)*dl + (i+k)*dk] = d0[k];
+        }
+    }
+}
+
+void legendre_pl_deriv(int lmin, int lmax, double x, double* p, double* dp)
+{
+    int l;
+    double p0, p1 = 1, p2 = x;
+    double q0, q1 = 0, q2 = 1;
+    for(l = 2; l < lmin+2; ++l)
+    {
+        p0 = p1;
+        p1 = p2;
+        p2 = ((2*l-1)*x*p1 - (l-1)*p0)/l;
+        q0 = q1;
+        q1 = q2;
+        q2 = ((2*l-1)*(x*q1 + p1) - (l-1)*q0)/l;
+    }
+    if(lmax >= lmin+0)
+        p[0] = p1, dp[0] = q1;
+    if(lmax >= lmin+1)
+        p[1] = p2, dp[1] = q2;
+    for(l = lmin+2; l <= lmax; ++l)
+    {
+        p[l-lmin] = ((2*l-1)*x*p[l-1-lmin] - (l-1)*p[l-2-lmin])/l;
+        dp[l-lmin] = ((2*l-1)*(x*dp[l-1-lmin] + p[l-1-lmin])
+                                                    - (l-1)*dp[l-2-lmin])/l;
+    }
+}
+
+void wigner_dl_deriv(int l0, int l1, int n, int m, double theta, double* d,
+                     double* dd)
+{
+    double d0, d1, d2, e0, e1, e2, f, g, h, j, s, u, v, x;
+    int l, lp, a, b, c;
+    
+    if(n == 0 && m == 0)
+    {
+        s = sin(theta);
+        legendre_pl_deriv(l0, l1, cos(theta), d, dd);
+        for(l = l0; l <= l1; ++l)
+            dd[l-l0] *= -s;
+        return;
+    }
+    
+    if(abs(n) > abs(m))
+    {
+        if(n > 0)
+            lp = n, a = n - m, b = n + m, c = n - m;
+        else
+            lp = -n, a = m - n, b = -n - m, c = 0;
+    }
+    else
+    {
+        if(m > 0)
+            lp = m, a = m - n, b = n + m, c = 0;
+        else
+            lp = -m, a = n - m, b = -n - m, c = n - m;
+    }
+    
+    u = sin(0.5*theta);
+    v = cos(0.5*theta);
+    x = v*v - u*u;
+    s = 2*u*v;
+    
+    // starting value and its derivative, written without dividing by u or v
+    // so that the end points theta = 0, pi are exact
+    f = (1 - 2*(c&1))*sqrt(binom(a+b, a));
+    if(fabs(f) <= DBL_MAX)
+    {
+        d0 = f*pow(u, a)*pow(v, b);
+        e0 = 0;
+        if(a > 0)
+            e0 += 0.5*a*f*pow(u, a-1)*pow(v, b+1);
+        if(b > 0)
+            e0 -= 0.5*b*f*pow(u, a+1)*pow(v, b-1);
+    }
+    else
+    {
+        // large spins, where d0 vanishes at the end points
+        d0 = dl_start(a, b, c, u, v);
+        e0 = u > 0 && v > 0 ? 0.5*d0*(a*v/u - b*u/v) : 0;
+    }
+    
+    // the derivative of the recurrence for d is a recurrence for dd with the
+    // same coefficients and an inhomogeneous term from d/dtheta cos(theta)
+    d1 = 0;
+    e1 = 0;
+    j = n*m;
+    
+    for(l = l0; l < lp && l <= l1; ++l)
+        *(d++) = 0, *(dd++) = 0;
+    if(l == lp && lp <= l1)
+        *(d++) = d0, *(dd++) = e0;
+    for(l = lp+1; l <= l1; ++l)
+    {
+        u = (1.-1./(l-n))*(1.-1./(l+n));
+        v = (1.-1./(l-m))*(1.-1./(l+m));
+        
+        f = sqrt((1-u)*(1-v));
+        g = (1.+1./(l-1))*sqrt(u*v);
+        h = l*x-j/(l-1);
+        
+        d2 = d1;
+        d1 = d0;
+        d0 = h*f*d1 - g*d2;
+        
+        e2 = e1;
+        e1 = e0;
+        e0 = h*f*e1 - l*s*f*d1 - g*e2;
+        
+        if(l >= l0)
+            *(d++) = d0, *(dd++) = e0;
+    }
+}
@@ -0,0 +1,163 @@
+// compute bin-averaged Wigner d-functions and Legendre polynomials
+//
+// notes:
+// - the bin average is taken over the solid angle of the annulus, that is,
+//   uniformly in cos(theta)
+// - Legendre polynomials are averaged exactly using the recurrence for their
+//   integrals; other d-functions are averaged by Gauss-Legendre quadrature
+// - the quadrature nodes only depend on lmax and the width of the bin, and
+//   are kept in a plan that can be applied to any number of bins up to that
+//   width; the plan also holds the row of d functions for each node, so that
+//   applying it does not allocate
+
+#include <stdlib.h>
+#include <math.h>
+
+#include "wigner.h"
+
+// number of quadrature points beyond the oscillation scale of d^l
+#ifndef BINAVG_EXTRA
+#define BINAVG_EXTRA 8
+#endif
+
+// average of P_l over [xb, xb+dx] from the recurrence for the difference
+// quotients R_l = (P_l(xb+dx) - P_l(xb))/dx and the identity
+// (2l+1) P_l = P'_{l+1} - P'_{l-1}
+static void binavg_pl(int lmin, int lmax, double xb, double dx, double* p)
+{
+    int l;
+    double xa, p0, p1, p2, r0, r1, r2;
+
+    xa = xb + dx;
+    p1 = 1;
+    p2 = xb;
+    r1 = 0;
+    r2 = 1;
+    if(lmin == 0 && lmax >= 0)
+        *(p++) = 1;
+    for(l = 2; l <= lmax+1; ++l)
+    {
+        r0 = r1;
+        r1 = r2;
+        r2 = ((2*l-1)*(xa*r1 + p2) - (l-1)*r0)/l;
+        p0 = p1;
+        p1 = p2;
+        p2 = ((2*l-1)*xb*p1 - (l-1)*p0)/l;
+        if(l > lmin)
+            *(p++) = (r2 - r0)/(2*l-1);
+    }
+}
+
+void legendre_pl_binavg(int lmin, int lmax, double xa, double xb, double* p)
+{
+    if(xa < xb)
+        binavg_pl(lmin, lmax, xa, xb - xa, p);
+    else
+        binavg_pl(lmin, lmax, xb, xa - xb, p);
+}
+
+int wigner_dl_binavg_init(struct wigner_dl_binavg_plan* plan, int lmax,
+                          double width)
+{
+    if(lmax < 0 || !(width >= 0))
+        return 2;
+
+    // enough points to resolve the oscillations of d^l across the bin
+    plan->lmax = lmax;
+    plan->width = width;
+    plan->n = BINAVG_EXTRA + (int)(0.5*(lmax+1)*width);
+    plan->x = malloc((2*plan->n + lmax+1)*sizeof(double));
+    if(!plan->x)
+        return 1;
+    plan->w = plan->x + plan->n;
+    plan->dl = plan->w + plan->n;
+
+    gauss_legendre(plan->n, plan->x, plan->w);
+
+    return 0;
+}
+
+void wigner_dl_binavg_free(struct wigner_dl_binavg_plan* plan)
+{
+    free(plan->x);
+    plan->x = plan->w = plan->dl = NULL;
+    plan->n = 0;
+}
+
+int wigner_dl_binavg_apply(struct wigner_dl_binavg_plan* plan, int lmin,
+                           int lmax, int m1, int m2, double theta_a,
+                           double theta_b, double* d)
+{
+    int i, l, n;
+    double h, c, dx, s, t;
+    double* dl;
+
+    if(theta_a > theta_b)
+        t = theta_a, theta_a = theta_b, theta_b = t;
+
+    if(lmin > lmax || lmax > plan->lmax || theta_b - theta_a > plan->width)
+        return 2;
+
+    // width of the bin in cos(theta), without cancellation
+    dx = 2*sin(0.5*(theta_b+theta_a))*sin(0.5*(theta_b-theta_a));
+
+    if(m1 == 0 && m2 == 0)
+    {
+        binavg_pl(lmin, lmax, cos(theta_b), dx, d);
+        return 0;
+    }
+
+    if(dx == 0)
+    {
+        wigner_dl(lmin, lmax, m1, m2, theta_a, d);
+        return 0;
+    }
+
+    n = plan->n;
+    dl = plan->dl;
+
+    for(l = lmin; l <= lmax; ++l)
+        d[l-lmin] = 0;
+
+    // quadrature in theta with the weight sin(theta) of the solid angle
+    h = 0.5*(theta_b - theta_a);
+    c = 0.5*(theta_b + theta_a);
+    for(i = 0; i < n; ++i)
+    {
+        t = c + h*plan->x[i];
+        s = h*plan->w[i]*sin(t)/dx;
+        wigner_dl(lmin, lmax, m1, m2, t, dl);
+        for(l = lmin; l <= lmax; ++l)
+            d[l-lmin] += s*dl[l-lmin];
+    }
+
+    return 0;
+}
+
+int wigner_dl_binavg(int lmin, int lmax, int m1, int m2, double theta_a,
+                     double theta_b, double* d)
+{
+    struct wigner_dl_binavg_plan plan;
+    int ier;
+
+    // the quadrature is not needed for the Legendre polynomials
+    if(m1 == 0 && m2 == 0)
+    {
+        plan.lmax = lmax;
+        plan.width = fabs(theta_b - theta_a);
+        plan.n = 0;
+        return wigner_dl_binavg_apply(&plan, lmin, lmax, m1, m2, theta_a,
+                                      theta_b, d);
+    }
+
+    ier = wigner_dl_binavg_init(&plan, lmax, fabs(theta_b - theta_a));
+    if(ier)
+        return ier;
+
+    ier = wigner_dl_binavg_apply(&plan, lmin, lmax, m1, m2, theta_a, theta_b,
+                                 d);
+
+    wigner_dl_binavg_free(&plan);
+
+    return ier;
+}
@@ -0,0 +1,189 @@
+// execution contexts for the parallel batch routines
+//
+// notes:
+// - a context either owns a number of threads, which are run as an OpenMP
+//   team for each call, or wraps an external scheduler, which is handed the
+//   tasks of each call and runs them on its own workers
+// - callers split their work into more tasks than threads, with about equal
+//   cost per task, and the tasks are handed out one at a time to whichever
+//   thread is free, which absorbs the imbalance of costs that grow with l
+// - a context with one thread runs all tasks in the calling thread, without
+//   opening a parallel region
+// - each task of the library writes its own part of the results, and every
+//   sum is taken in a fixed order within a task or after all tasks are done,
+//   so that results are identical bit for bit on every context, whatever
+//   the number of threads and the order in which the tasks run
+// - tasks that can fail, mostly for lack of memory, are run by
+//   wigner_exec_try, which keeps a flag for each task and reports whether
+//   any of them failed once all are done
+// - with WIGNER_STATS, the counters of each task are kept apart and added to
+//   those of the calling thread once all tasks are done, so that the work of
+//   a call is seen by the caller on whichever threads it ran
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "wigner.h"
+#include "wigner_stats.h"
+
+void wigner_exec_init(struct wigner_exec* exec, int nthreads)
+{
+    if(nthreads < 1)
+    {
+#ifdef _OPENMP
+        nthreads = omp_get_max_threads();
+#else
+        nthreads = 1;
+#endif
+    }
+
+    exec->nthreads = nthreads;
+    exec->run = NULL;
+    exec->sched = NULL;
+}
+
+void wigner_exec_external(struct wigner_exec* exec, int nworkers,
+                          wigner_scheduler* run, void* sched)
+{
+    exec->nthreads = nworkers > 0 ? nworkers : 1;
+    exec->run = run;
+    exec->sched = sched;
+}
+
+int wigner_exec_threads(const struct wigner_exec* exec)
+{
+    if(exec)
+        return exec->nthreads;
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+static void exec_run(const struct wigner_exec* exec, int ntasks,
+                     wigner_task* task, void* arg)
+{
+    int i, nthreads;
+
+    if(exec && exec->run)
+    {
+        exec->run(exec->sched, ntasks, task, arg);
+        return;
+    }
+
+    nthreads = wigner_exec_threads(exec);
+    if(nthreads > ntasks)
+        nthreads = ntasks;
+
+    if(nthreads < 2)
+    {
+        for(i = 0; i < ntasks; ++i)
+            task(arg, i);
+        return;
+    }
+
+    #pragma omp parallel for num_threads(nthreads) schedule(dynamic, 1)
+    for(i = 0; i < ntasks; ++i)
+        task(arg, i);
+}
+
+#ifdef WIGNER_STATS
+
+// a task together with the counters of all tasks
+struct stats_task
+{
+    wigner_task* task;
+    void* arg;
+    struct wigner_stats* part;
+};
+
+// run a task with counters of its own, and keep those of the thread
+static void stats_task(void* arg, int i)
+{
+    const struct stats_task* s = arg;
+    struct wigner_stats save[WIGNER_STATS_N];
+
+    memcpy(save, wigner_stats_tls, sizeof(save));
+    memset(wigner_stats_tls, 0, sizeof(save));
+    s->task(s->arg, i);
+    memcpy(s->part + (size_t)i*WIGNER_STATS_N, wigner_stats_tls, sizeof(save));
+    memcpy(wigner_stats_tls, save, sizeof(save));
+}
+
+#endif
+
+void wigner_exec_run(const struct wigner_exec* exec, int ntasks,
+                     wigner_task* task, void* arg)
+{
+#ifdef WIGNER_STATS
+    struct stats_task s;
+#endif
+
+    if(ntasks < 1)
+        return;
+
+#ifdef WIGNER_STATS
+    // without memory for the counters, the tasks still run
+    s.part = calloc((size_t)ntasks*WIGNER_STATS_N,
+                    sizeof(struct wigner_stats));
+    if(s.part)
+    {
+        s.task = task;
+        s.arg = arg;
+        exec_run(exec, ntasks, stats_task, &s);
+        wigner_stats_add(ntasks, s.part);
+        free(s.part);
+        return;
+    }
+#endif
+
+    exec_run(exec, ntasks, task, arg);
+}
+
+// a task that can fail, with the flags of all tasks
+struct try_task
+{
+    wigner_try_task* task;
+    void* arg;
+    char* err;
+};
+
+// run a task and keep its flag
+static void try_task(void* arg, int i)
+{
+    const struct try_task* t = arg;
+
+    t->err[i] = t->task(t->arg, i) != 0;
+}
+
+int wigner_exec_try(const struct wigner_exec* exec, int ntasks,
+                    wigner_try_task* task, void* arg)
+{
+    struct try_task t;
+    int i, ier;
+
+    if(ntasks < 1)
+        return 0;
+
+    t.err = calloc(ntasks, 1);
+    if(!t.err)
+        return 1;
+    t.task = task;
+    t.arg = arg;
+
+    wigner_exec_run(exec, ntasks, try_task, &t);
+
+    ier = 0;
+    for(i = 0; i < ntasks; ++i)
+        if(t.err[i])
+            ier = 1;
+
+    free(t.err);
+
+    return ier;
+}
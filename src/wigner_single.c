@@ -0,0 +1,384 @@
+// compute single Wigner 3j and 6j symbols
+//
+// notes:
+// - small arguments use the Racah formulae, where each term of the sum is
+//   obtained from the previous one by its ratio
+// - large arguments use the recursions in l1 of wigner_3jj and wigner_6j,
+//   started from the end of the l1 range closer to the target, and stopped
+//   there; the values at either end are single terms of the Racah formulae,
+//   so that no normalisation over the whole range is needed
+// - the selection rules are checked before any other work is done
+
+#include <stdlib.h>
+#include <math.h>
+
+// largest l1+l2+l3 for which the Racah formula is used for 3j symbols
+#ifndef SINGLE_RACAH_3J
+#define SINGLE_RACAH_3J 30
+#endif
+
+// largest l1+l2+l4+l5 etc. for which the Racah formula is used for 6j symbols
+#ifndef SINGLE_RACAH_6J
+#define SINGLE_RACAH_6J 48
+#endif
+
+// values are rescaled when they grow beyond this during the recursion
+#define SINGLE_HUGE 1e150
+#define SINGLE_LNHUGE 345.38776394910684
+
+// log(n!) for n = 0, ..., LNFACT_N-1
+#define LNFACT_N 101
+static const double lnfact_tab[LNFACT_N] = {
+    0, 0, 0.69314718055994495,
+    1.7917594692280554, 3.1780538303479449, 4.7874917427820467,
+    6.5792512120101021, 8.5251613610654147, 10.604602902745249,
+    12.801827480081467, 15.104412573075514, 17.502307845873887,
+    19.987214495661885, 22.552163853123421, 25.191221182738683,
+    27.89927138384089, 30.671860106080672, 33.505073450136891,
+    36.395445208033053, 39.339884187199495, 42.335616460753485,
+    45.380138898476908, 48.47118135183522, 51.606675567764377,
+    54.784729398112319, 58.003605222980518, 61.261701761002008,
+    64.557538627006338, 67.889743137181526, 71.257038967168,
+    74.658236348830172, 78.092223553315307, 81.557959456115029,
+    85.054467017581516, 88.580827542197682, 92.136175603687093,
+    95.719694542143202, 99.330612454787428, 102.96819861451381,
+    106.63176026064346, 110.32063971475738, 114.03421178146169,
+    117.77188139974507, 121.53308151543864, 125.3172711493569,
+    129.12393363912722, 132.95257503561632, 136.80272263732635,
+    140.67392364823425, 144.5657439463449, 148.47776695177305,
+    152.40959258449732, 156.3608363030788, 160.3311282166309,
+    164.32011226319514, 168.32744544842765, 172.35279713916282,
+    176.39584840699737, 180.45629141754375, 184.53382886144948,
+    188.62817342367163, 192.7390472878449, 196.86618167288998,
+    201.00931639928152, 205.16819948264123, 209.34258675253685,
+    213.53224149456327, 217.73693411395419, 221.95644181913036,
+    226.1905483237276, 230.43904356577693, 234.70172344281826,
+    238.97838956183432, 243.26884900298276, 247.57291409618691,
+    251.89040220972316, 256.22113555000954, 260.56494097186322,
+    264.92164979855283, 269.29109765101981, 273.67312428569369,
+    278.06757344036612, 282.47429268763034, 286.89313329542699,
+    291.32395009427034, 295.7666013507606, 300.22094864701415,
+    304.68685676566867, 309.16419358014696, 313.65282994987905,
+    318.15263962020936, 322.66349912672626, 327.1852877037752,
+    331.71788719692847, 336.26118197919851, 340.81505887079896,
+    345.37940706226686, 349.95411804077025, 354.53908551944085,
+    359.1342053695754, 363.73937555556347
+};
+
+static inline double lnfact(int n)
+{
+    return n < LNFACT_N ? lnfact_tab[n] : lgamma(n+1.);
+}
+
+static inline int phase(int m)
+{
+    return 1-2*(m&1);
+}
+
+static inline int imin(int a, int b)
+{
+    return a < b ? a : b;
+}
+
+static inline int imax(int a, int b)
+{
+    return a > b ? a : b;
+}
+
+// twice the argument, which must be integer or half-integer
+static inline int twoj(double x, int* t)
+{
+    *t = (int)floor(2*x + 0.5);
+    return fabs(2*x - *t) < 0.02;
+}
+
+// triangle condition for twice the arguments, including integer perimeter
+static inline int triangle(int a, int b, int c)
+{
+    return a+b-c >= 0 && a-b+c >= 0 && -a+b+c >= 0 && !((a+b+c)&1);
+}
+
+// log of the triangle coefficient for twice the arguments
+static inline double lntri(int a, int b, int c)
+{
+    return 0.5*(lnfact((a+b-c)/2) + lnfact((a-b+c)/2) + lnfact((-a+b+c)/2)
+                - lnfact((a+b+c)/2+1));
+}
+
+// Racah formula for the 3j symbol, with twice the arguments; the result is
+// the returned value times exp(*scale)
+static double racah_3j(int j1, int j2, int j3, int m1, int m2, int m3,
+                       double* scale)
+{
+    int a, b, c, d, e, k, kmin, kmax;
+    double s, t;
+
+    // arguments of the factorials in the sum for k = 0
+    a = (j3-j2+m1)/2;
+    b = (j3-j1-m2)/2;
+    c = (j1+j2-j3)/2;
+    d = (j1-m1)/2;
+    e = (j2+m2)/2;
+
+    kmin = imax(0, imax(-a, -b));
+    kmax = imin(c, imin(d, e));
+
+    *scale = lntri(j1, j2, j3)
+           + 0.5*(lnfact((j1+m1)/2) + lnfact(d) + lnfact(e) + lnfact((j2-m2)/2)
+                  + lnfact((j3+m3)/2) + lnfact((j3-m3)/2))
+           - lnfact(kmin) - lnfact(a+kmin) - lnfact(b+kmin) - lnfact(c-kmin)
+           - lnfact(d-kmin) - lnfact(e-kmin);
+
+    s = t = 1;
+    for(k = kmin; k < kmax; ++k)
+    {
+        t *= -(double)(c-k)*(d-k)*(e-k)/((double)(k+1)*(a+k+1)*(b+k+1));
+        s += t;
+    }
+
+    return phase((j1-j2-m3)/2+kmin)*s;
+}
+
+// Racah formula for the 6j symbol, with twice the arguments; the result is
+// the returned value times exp(*scale)
+static double racah_6j(int j1, int j2, int j3, int j4, int j5, int j6,
+                       double* scale)
+{
+    int a1, a2, a3, a4, b1, b2, b3, k, kmin, kmax;
+    double s, t;
+
+    a1 = (j1+j2+j3)/2;
+    a2 = (j1+j5+j6)/2;
+    a3 = (j4+j2+j6)/2;
+    a4 = (j4+j5+j3)/2;
+    b1 = (j1+j2+j4+j5)/2;
+    b2 = (j2+j3+j5+j6)/2;
+    b3 = (j3+j1+j6+j4)/2;
+
+    kmin = imax(imax(a1, a2), imax(a3, a4));
+    kmax = imin(b1, imin(b2, b3));
+
+    *scale = lntri(j1, j2, j3) + lntri(j1, j5, j6) + lntri(j4, j2, j6)
+           + lntri(j4, j5, j3) + lnfact(kmin+1) - lnfact(kmin-a1)
+           - lnfact(kmin-a2) - lnfact(kmin-a3) - lnfact(kmin-a4)
+           - lnfact(b1-kmin) - lnfact(b2-kmin) - lnfact(b3-kmin);
+
+    s = t = 1;
+    for(k = kmin; k < kmax; ++k)
+    {
+        t *= -(double)(k+2)*(b1-k)*(b2-k)*(b3-k)
+             / ((double)(k+1-a1)*(k+1-a2)*(k+1-a3)*(k+1-a4));
+        s += t;
+    }
+
+    return phase(kmin)*s;
+}
+
+// coefficients of the recursion
+//   l E(l+1) f(l+1) + (2l+1) D(l) f(l) + (l+1) E(l) f(l-1) = 0
+// where D(l) is replaced by its limit D(l)/l for l = 0
+typedef void (*single_coef)(const double* p, double l, double* e, double* d);
+
+// coefficients for the 3j symbol, with p = (l2, l3, m1, m2, m3)
+static void coef_3j(const double* p, double l, double* e, double* d)
+{
+    const double l2 = p[0], l3 = p[1], m1 = p[2], m2 = p[3], m3 = p[4];
+    *e = sqrt((l+l2+l3+1)*(l-l2+l3)*(l+l2-l3)*(-l+l2+l3+1)*(l+m1)*(l-m1));
+    if(l > 0)
+        *d = - l2*(l2+1)*m1 + l3*(l3+1)*m1 + l*(l+1)*(m3-m2);
+    else
+        *d = m3-m2;
+}
+
+// coefficients for the 6j symbol, with p = (l2, l3, l4, l5, l6)
+static void coef_6j(const double* p, double l, double* e, double* d)
+{
+    const double l2 = p[0], l3 = p[1], l4 = p[2], l5 = p[3], l6 = p[4];
+    *e = sqrt((l+l2+l3+1)*(l-l2+l3)*(l+l2-l3)*(-l+l2+l3+1)
+              * (l+l5+l6+1)*(l-l5+l6)*(l+l5-l6)*(-l+l5+l6+1));
+    if(l > 0)
+        *d = 2*(l2*(l2+1)*l5*(l5+1) + l3*(l3+1)*l6*(l6+1) - l*(l+1)*l4*(l4+1))
+             - (l2*(l2+1) + l3*(l3+1) - l*(l+1))
+               * (l5*(l5+1) + l6*(l6+1) - l*(l+1));
+    else
+        *d = 2*(l2*(l2+1) + l5*(l5+1) - l4*(l4+1));
+}
+
+// run the recursion from l0, where the value is f0 times exp(s0), to l in
+// direction dir = +1 or -1; if check is set, give up and set *ok to zero
+// once the recursion runs into the direction of decreasing values in a
+// classically forbidden region, where it is unstable
+static double single_walk(single_coef coef, const double* p, double l0,
+                          double l, int dir, double f0, double s0, int check,
+                          int* ok)
+{
+    int i, n;
+    double c1, c2, d, e, en, f, fn, fp;
+
+    n = (int)(fabs(l-l0) + 0.5);
+
+    *ok = 1;
+    f = f0;
+    fp = 0;
+    coef(p, l0, &e, &d);
+    en = 0;
+
+    for(i = 0; i < n; ++i)
+    {
+        if(dir > 0)
+        {
+            en = e;
+            coef(p, l0+1, &e, &fn);
+            if(l0 > 0)
+            {
+                c1 = -(2*l0+1)*d/(l0*e);
+                c2 = -(l0+1)*en/(l0*e);
+            }
+            else
+            {
+                c1 = -d/e;
+                c2 = 0;
+            }
+            d = fn;
+            l0 += 1;
+        }
+        else
+        {
+            c1 = -(2*l0+1)*d/((l0+1)*e);
+            c2 = -l0*en/((l0+1)*e);
+            en = e;
+            l0 -= 1;
+            coef(p, l0, &e, &d);
+        }
+
+        fn = c1*f + c2*fp;
+
+        // outside of the oscillatory region, where f(l+1) = c1 f(l) + c2 f(l-1)
+        // has complex characteristic roots, values must not decrease
+        if(check && i > 0 && i < n-1 && c1*c1 + 4*c2 >= 0
+                && fabs(fn) < fabs(f))
+        {
+            *ok = 0;
+            return 0;
+        }
+
+        fp = f;
+        f = fn;
+
+        if(fabs(f) > SINGLE_HUGE)
+        {
+            f /= SINGLE_HUGE;
+            fp /= SINGLE_HUGE;
+            s0 += SINGLE_LNHUGE;
+        }
+    }
+
+    return f*exp(s0);
+}
+
+// value at l from the recursion in [lmin, lmax], started from the closer end
+static double single_rec(single_coef coef, const double* p, double lmin,
+                         double lmax, double l, double fmin, double smin,
+                         double fmax, double smax)
+{
+    int ok;
+    double f;
+
+    if(l-lmin <= lmax-l)
+    {
+        f = single_walk(coef, p, lmin, l, +1, fmin, smin, 1, &ok);
+        if(!ok)
+            f = single_walk(coef, p, lmax, l, -1, fmax, smax, 0, &ok);
+    }
+    else
+    {
+        f = single_walk(coef, p, lmax, l, -1, fmax, smax, 1, &ok);
+        if(!ok)
+            f = single_walk(coef, p, lmin, l, +1, fmin, smin, 0, &ok);
+    }
+
+    return f;
+}
+
+double wigner_3j_single(double l1, double l2, double l3, double m1, double m2,
+                        double m3)
+{
+    int j1, j2, j3, n1, n2, n3, jmin, jmax;
+    double fmin, fmax, smin, smax;
+    double p[5];
+
+    if(!twoj(l1, &j1) || !twoj(l2, &j2) || !twoj(l3, &j3) || !twoj(m1, &n1)
+            || !twoj(m2, &n2) || !twoj(m3, &n3))
+        return 0;
+
+    // selection rules
+    if(n1+n2+n3 != 0)
+        return 0;
+    if(abs(n1) > j1 || abs(n2) > j2 || abs(n3) > j3)
+        return 0;
+    if(((j1+n1)&1) || ((j2+n2)&1) || ((j3+n3)&1))
+        return 0;
+    if(!triangle(j1, j2, j3))
+        return 0;
+    if(n1 == 0 && n2 == 0 && ((j1+j2+j3)/2)&1)
+        return 0;
+
+    if((j1+j2+j3)/2 <= SINGLE_RACAH_3J)
+    {
+        fmin = racah_3j(j1, j2, j3, n1, n2, n3, &smin);
+        return fmin*exp(smin);
+    }
+
+    // recursion in l1 between the closed-form values at either end
+    jmin = imax(abs(j2-j3), abs(n1));
+    jmax = j2+j3;
+    fmin = racah_3j(jmin, j2, j3, n1, n2, n3, &smin);
+    fmax = racah_3j(jmax, j2, j3, n1, n2, n3, &smax);
+
+    p[0] = 0.5*j2;
+    p[1] = 0.5*j3;
+    p[2] = 0.5*n1;
+    p[3] = 0.5*n2;
+    p[4] = 0.5*n3;
+
+    return single_rec(coef_3j, p, 0.5*jmin, 0.5*jmax, 0.5*j1, fmin, smin, fmax,
+                      smax);
+}
+
+double wigner_6j_single(double l1, double l2, double l3, double l4, double l5,
+                        double l6)
+{
+    int j1, j2, j3, j4, j5, j6, jmin, jmax;
+    double fmin, fmax, smin, smax;
+    double p[5];
+
+    if(!twoj(l1, &j1) || !twoj(l2, &j2) || !twoj(l3, &j3) || !twoj(l4, &j4)
+            || !twoj(l5, &j5) || !twoj(l6, &j6))
+        return 0;
+
+    // selection rules
+    if(!triangle(j1, j2, j3) || !triangle(j1, j5, j6)
+            || !triangle(j4, j2, j6) || !triangle(j4, j5, j3))
+        return 0;
+
+    if(imin(j1+j2+j4+j5, imin(j2+j3+j5+j6, j3+j1+j6+j4))/2 <= SINGLE_RACAH_6J)
+    {
+        fmin = racah_6j(j1, j2, j3, j4, j5, j6, &smin);
+        return fmin*exp(smin);
+    }
+
+    // recursion in l1 between the closed-form values at either end
+    jmin = imax(abs(j2-j3), abs(j5-j6));
+    jmax = imin(j2+j3, j5+j6);
+    fmin = racah_6j(jmin, j2, j3, j4, j5, j6, &smin);
+    fmax = racah_6j(jmax, j2, j3, j4, j5, j6, &smax);
+
+    p[0] = 0.5*j2;
+    p[1] = 0.5*j3;
+    p[2] = 0.5*j4;
+    p[3] = 0.5*j5;
+    p[4] = 0.5*j6;
+
+    return single_rec(coef_6j, p, 0.5*jmin, 0.5*jmax, 0.5*j1, fmin, smin, fmax,
+                      smax);
+}
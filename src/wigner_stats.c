@@ -0,0 +1,60 @@
+// query and reset the instrumentation counters of the 3j and 6j recursions
+//
+// notes:
+// - counters are only collected if the library is built with WIGNER_STATS
+//   defined, otherwise wigner_stats_get() returns zero counters and a
+//   non-zero value
+// - counters belong to the calling thread, and the counters of the tasks of
+//   wigner_exec_run are added to those of the thread that called it, so that
+//   a query after a parallel call sees all of its work
+
+#include <string.h>
+
+#include "wigner_stats.h"
+
+#ifdef WIGNER_STATS
+WIGNER_TLS struct wigner_stats wigner_stats_tls[WIGNER_STATS_N];
+
+void wigner_stats_add(int n, const struct wigner_stats* stats)
+{
+    int i, r;
+    struct wigner_stats* t;
+
+    for(i = 0; i < n; ++i)
+    {
+        for(r = 0; r < WIGNER_STATS_N; ++r, ++stats)
+        {
+            t = &wigner_stats_tls[r];
+            t->calls += stats->calls;
+            t->coefs += stats->coefs;
+            t->rescales += stats->rescales;
+            t->fwd_steps += stats->fwd_steps;
+            t->bwd_steps += stats->bwd_steps;
+            t->nobac += stats->nobac;
+            t->zeroed += stats->zeroed;
+        }
+    }
+}
+#endif
+
+int wigner_stats_get(int routine, struct wigner_stats* stats)
+{
+    memset(stats, 0, sizeof(struct wigner_stats));
+
+    if(routine < 0 || routine >= WIGNER_STATS_N)
+        return 2;
+
+#ifdef WIGNER_STATS
+    *stats = wigner_stats_tls[routine];
+    return 0;
+#else
+    return 1;
+#endif
+}
+
+void wigner_stats_reset(void)
+{
+#ifdef WIGNER_STATS
+    memset(wigner_stats_tls, 0, sizeof(wigner_stats_tls));
+#endif
+}
@@ -0,0 +1,33 @@
+// internal counters for the 3j and 6j recursions
+//
+// notes:
+// - the counters exist only if the library is built with WIGNER_STATS
+//   defined, otherwise WIGNER_STATS_ADD expands to nothing
+// - counters are thread-local, so that the recursions stay free of shared
+//   writes when called from parallel loops; wigner_exec_run collects the
+//   counters of each task and adds them to those of the calling thread
+
+#pragma once
+
+#include "wigner.h"
+
+#ifdef WIGNER_STATS
+
+#ifdef _MSC_VER
+#define WIGNER_TLS __declspec(thread)
+#else
+#define WIGNER_TLS __thread
+#endif
+
+extern WIGNER_TLS struct wigner_stats wigner_stats_tls[WIGNER_STATS_N];
+
+#define WIGNER_STATS_ADD(r, field, n) (wigner_stats_tls[r].field += (n))
+
+// add n sets of counters for all routines to those of the calling thread
+void wigner_stats_add(int n, const struct wigner_stats* stats);
+
+#else
+
+#define WIGNER_STATS_ADD(r, field, n) ((void)0)
+
+#endif
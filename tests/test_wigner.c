@@ -0,0 +1,2580 @@
+// differential tests of accuracy and performance
+//
+// notes:
+// - reference values for small l are computed from exact integer sums: the
+//   Racah formulae for the 3j and 6j symbols, written in terms of binomial
+//   coefficients, and the Fourier series of the d functions over the values
+//   of d^l at theta = pi/2; only the prefactors and the Fourier modes are
+//   rounded, in long double
+// - for large l, where no reference is available, identities are checked:
+//   the normalisation of rows of 3j and 6j symbols, the unitarity of the d
+//   matrix, and the addition theorem of the d functions
+// - variants of the routines (integer arguments, single values, blocks,
+//   batches, chunked and segmented rows, several spins) are compared with
+//   the plain routines
+// - errors are collected in histograms of ULP and relative error, and shown
+//   next to the time spent in the library; each check fails if the largest
+//   error, in units of DBL_EPSILON times the largest value of the row,
+//   exceeds its tolerance
+// - the rounding errors of the recurrences of the d functions grow as
+//   l min(l, 1/sin(theta)), and their errors are measured in these units
+// - the reference values lose accuracy if long double is no wider than
+//   double, and the tolerances can be scaled with TEST_TOL_SCALE
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <float.h>
+#include <time.h>
+
+#include "wigner.h"
+
+// factor for all tolerances
+#ifndef TEST_TOL_SCALE
+#define TEST_TOL_SCALE 1
+#endif
+
+// largest l of the reference values, as limited by 64-bit integer sums
+#define REF_3J 10
+#define REF_6J 6
+#define REF_DL 30
+
+// size of the tables of binomial coefficients and factorials
+#define BINOM_N 64
+#define FACT_N 128
+
+// number of bins of the error histograms
+#define NBINS 8
+
+#define PI 3.14159265358979323846
+
+// upper edges of the histogram bins, in ULP and in relative error
+static const double ulp_edges[NBINS-1] = {
+    0.5, 1, 2, 4, 16, 256, 4096 };
+static const double rel_edges[NBINS-1] = {
+    1e-16, 1e-15, 1e-14, 1e-13, 1e-12, 1e-10, 1e-8 };
+
+static long long binom_tab[BINOM_N][BINOM_N];
+static long double fact[FACT_N];
+
+struct check
+{
+    const char* name;
+    double tol;
+    long n;
+    long ulp[NBINS];
+    long rel[NBINS];
+    double maxulp, maxrel, maxerr;
+    clock_t time;
+};
+
+static int nfail = 0;
+
+// time spent in the library call
+#define TIMED(c, call) \
+    do { clock_t t_ = clock(); call; (c)->time += clock() - t_; } while(0)
+
+static void init_tables(void)
+{
+    int n, k;
+
+    for(n = 0; n < BINOM_N; ++n)
+    {
+        binom_tab[n][0] = binom_tab[n][n] = 1;
+        for(k = 1; k < n; ++k)
+            binom_tab[n][k] = binom_tab[n-1][k-1] + binom_tab[n-1][k];
+    }
+
+    fact[0] = 1;
+    for(n = 1; n < FACT_N; ++n)
+        fact[n] = n*fact[n-1];
+}
+
+static long long binom(int n, int k)
+{
+    return k < 0 || k > n ? 0 : binom_tab[n][k];
+}
+
+static int odd(int n)
+{
+    return n % 2 != 0;
+}
+
+static void check_begin(struct check* c, const char* name, double tol)
+{
+    int i;
+
+    c->name = name;
+    c->tol = TEST_TOL_SCALE*tol;
+    c->n = 0;
+    for(i = 0; i < NBINS; ++i)
+        c->ulp[i] = c->rel[i] = 0;
+    c->maxulp = c->maxrel = c->maxerr = 0;
+    c->time = 0;
+}
+
+static int bin(const double* edges, double x)
+{
+    int i;
+    for(i = 0; i < NBINS-1 && !(x <= edges[i]); ++i) {}
+    return i;
+}
+
+// add the error of value x against the reference, for a row with the given
+// largest absolute value
+static void check_add(struct check* c, double x, long double ref, double scale)
+{
+    double err, ulp, rel;
+
+    err = (double)fabsl(x - ref);
+    if(ref != 0)
+    {
+        ulp = err/fmax(ldexp(DBL_EPSILON, ilogb((double)ref)), DBL_MIN);
+        rel = err/(double)fabsl(ref);
+    }
+    else
+        ulp = rel = err == 0 ? 0 : HUGE_VAL;
+    err /= DBL_EPSILON*(scale > 0 ? scale : 1);
+
+    c->n += 1;
+    c->ulp[bin(ulp_edges, ulp)] += 1;
+    c->rel[bin(rel_edges, rel)] += 1;
+    if(ulp > c->maxulp)
+        c->maxulp = ulp;
+    if(rel > c->maxrel)
+        c->maxrel = rel;
+    if(!(err <= c->maxerr))
+        c->maxerr = err;
+}
+
+// add a row of values against a row of reference values
+static void check_row(struct check* c, int n, const double* x,
+                      const long double* ref)
+{
+    int i;
+    double scale = 0;
+
+    for(i = 0; i < n; ++i)
+        if(fabsl(ref[i]) > scale)
+            scale = (double)fabsl(ref[i]);
+    for(i = 0; i < n; ++i)
+        check_add(c, x[i], ref[i], scale);
+}
+
+// add a row of d functions against a row of reference values, in units of
+// the largest value of the row times the growth l min(l, 1/sin(theta)) of
+// the rounding errors of the recurrences in l
+static void check_row_dl(struct check* c, int n, const double* x,
+                         const long double* ref, double theta)
+{
+    int i;
+    double scale = 0, s;
+
+    for(i = 0; i < n; ++i)
+        if(fabsl(ref[i]) > scale)
+            scale = (double)fabsl(ref[i]);
+    s = fabs(sin(theta));
+    for(i = 0; i < n; ++i)
+        check_add(c, x[i], ref[i], scale*fmax(1, i*fmin(i, 1/s)));
+}
+
+static void check_end(struct check* c)
+{
+    int i, ok;
+
+    ok = c->n > 0 && c->maxerr <= c->tol;
+    if(!ok)
+        nfail += 1;
+
+    printf("%-28s %9ld %8.3f s %8.1f ns   err %9.3g / %-9.3g %s\n",
+           c->name, c->n, (double)c->time/CLOCKS_PER_SEC,
+           c->n > 0 ? 1e9*c->time/CLOCKS_PER_SEC/c->n : 0., c->maxerr,
+           c->tol, ok ? "ok" : "FAIL");
+    printf("    ulp  ");
+    for(i = 0; i < NBINS; ++i)
+        printf(" %9ld", c->ulp[i]);
+    printf("   max %.3g\n", c->maxulp);
+    printf("    rel  ");
+    for(i = 0; i < NBINS; ++i)
+        printf(" %9ld", c->rel[i]);
+    printf("   max %.3g\n", c->maxrel);
+}
+
+// reference 3j symbol for doubled arguments, from the Racah formula as a sum
+// of products of binomial coefficients
+static long double ref_3j(int tj1, int tj2, int tj3, int tm1, int tm2, int tm3)
+{
+    int J, a, b, c, k1, k2, k;
+    long long s;
+    long double r;
+
+    if(tm1 + tm2 + tm3 != 0 || odd(tj1+tj2+tj3) || tj3 < abs(tj1-tj2)
+            || tj3 > tj1+tj2 || abs(tm1) > tj1 || abs(tm2) > tj2
+            || abs(tm3) > tj3 || odd(tj1+tm1) || odd(tj2+tm2))
+        return 0;
+
+    J = (tj1 + tj2 + tj3)/2;
+    a = J - tj3;
+    b = J - tj2;
+    c = J - tj1;
+    k1 = (tj1 - tm1)/2;
+    k2 = (tj2 + tm2)/2;
+
+    s = 0;
+    for(k = 0; k <= a; ++k)
+        s += (k % 2 ? -1 : 1)*binom(a, k)*binom(b, k1-k)*binom(c, k2-k);
+
+    r = (long double)binom(tj1, b)*binom(tj2, c)
+        / ((long double)binom(J+1, a)*(tj3+1)*binom(tj1, k1)
+           *binom(tj2, (tj2-tm2)/2)*binom(tj3, (tj3-tm3)/2));
+
+    return (odd((tj1-tj2-tm3)/2) ? -1 : 1)*s*sqrtl(r);
+}
+
+static long double ref_tri(int ta, int tb, int tc)
+{
+    return fact[(ta+tb-tc)/2]*fact[(ta-tb+tc)/2]*fact[(-ta+tb+tc)/2]
+            / fact[(ta+tb+tc)/2+1];
+}
+
+static int ref_istri(int ta, int tb, int tc)
+{
+    return !odd(ta+tb+tc) && tc >= abs(ta-tb) && tc <= ta+tb;
+}
+
+// reference 6j symbol for doubled arguments, from the Racah formula, where
+// each term is (k+1) times a multinomial coefficient
+static long double ref_6j(int tj1, int tj2, int tj3, int tj4, int tj5, int tj6)
+{
+    int a[4], b[3], p[7], i, k, kmin, kmax, n;
+    long long s, t;
+
+    if(!ref_istri(tj1, tj2, tj3) || !ref_istri(tj1, tj5, tj6)
+            || !ref_istri(tj4, tj2, tj6) || !ref_istri(tj4, tj5, tj3))
+        return 0;
+
+    a[0] = (tj1 + tj2 + tj3)/2;
+    a[1] = (tj1 + tj5 + tj6)/2;
+    a[2] = (tj4 + tj2 + tj6)/2;
+    a[3] = (tj4 + tj5 + tj3)/2;
+    b[0] = (tj1 + tj2 + tj4 + tj5)/2;
+    b[1] = (tj2 + tj3 + tj5 + tj6)/2;
+    b[2] = (tj3 + tj1 + tj6 + tj4)/2;
+
+    kmin = a[0];
+    for(i = 1; i < 4; ++i)
+        if(a[i] > kmin)
+            kmin = a[i];
+    kmax = b[0];
+    for(i = 1; i < 3; ++i)
+        if(b[i] < kmax)
+            kmax = b[i];
+
+    s = 0;
+    for(k = kmin; k <= kmax; ++k)
+    {
+        for(i = 0; i < 4; ++i)
+            p[i] = k - a[i];
+        for(i = 0; i < 3; ++i)
+            p[4+i] = b[i] - k;
+        t = k + 1;
+        n = k;
+        for(i = 0; i < 7; ++i)
+        {
+            t *= binom(n, p[i]);
+            n -= p[i];
+        }
+        s += (k % 2 ? -1 : 1)*t;
+    }
+
+    return s*sqrtl(ref_tri(tj1, tj2, tj3)*ref_tri(tj1, tj5, tj6)
+                   *ref_tri(tj4, tj2, tj6)*ref_tri(tj4, tj5, tj3));
+}
+
+// table of d^j_{a,b}(pi/2) for j <= REF_DL
+#define DELTA_N (2*REF_DL+1)
+#define DELTA(tab, j, a, b) \
+    (tab)[((j)*DELTA_N + (a)+REF_DL)*DELTA_N + (b)+REF_DL]
+
+static long double* ref_delta(void)
+{
+    int j, a, b, s;
+    long long t;
+    long double* tab;
+
+    tab = calloc((REF_DL+1)*DELTA_N*DELTA_N, sizeof(long double));
+    if(!tab)
+        return NULL;
+
+    for(j = 0; j <= REF_DL; ++j)
+    {
+        for(a = -j; a <= j; ++a)
+        {
+            for(b = -j; b <= j; ++b)
+            {
+                t = 0;
+                for(s = 0; s <= 2*j; ++s)
+                    t += (odd(a-b+s) ? -1 : 1)*binom(j+b, s)*binom(j-b, j-a-s);
+                DELTA(tab, j, a, b) = ldexpl(sqrtl(fact[j+a]*fact[j-a]
+                                                   / (fact[j+b]*fact[j-b]))
+                                             * t, -j);
+            }
+        }
+    }
+
+    return tab;
+}
+
+// reference d^j_{m1,m2}(theta) and its derivative from Wigner's formula,
+// which is accurate to the last bits unless the terms cancel; returns the
+// ratio of the sum of absolute terms to the absolute sum
+static long double ref_dl_sum(int j, int m1, int m2, long double theta,
+                              long double* d, long double* dd)
+{
+    int s, p, q;
+    long double c, t, u, a, b, sa;
+
+    c = cosl(0.5L*theta);
+    t = tanl(0.5L*theta);
+    a = b = sa = 0;
+    for(s = 0; s <= 2*j; ++s)
+    {
+        // powers of cos and sin of theta/2
+        p = 2*j + m2 - m1 - 2*s;
+        q = m1 - m2 + 2*s;
+        if(p < 0 || q < 0 || j+m2-s < 0 || j-m1-s < 0)
+            continue;
+        u = (odd(m1-m2+s) ? -1 : 1)*(long double)binom(j+m2, s)
+            * binom(j-m2, j-m1-s)*powl(c, 2*j)*powl(t, q);
+        a += u;
+        b += u*(0.5L*q/t - 0.5L*p*t);
+        sa += fabsl(u);
+    }
+    u = sqrtl(fact[j+m1]*fact[j-m1]/(fact[j+m2]*fact[j-m2]));
+    *d = u*a;
+    *dd = u*b;
+    return a != 0 ? sa/fabsl(a) : HUGE_VALL;
+}
+
+// reference d^j_{m1,m2}(theta) and its derivative, either from Wigner's
+// formula, or from the Fourier series
+//   d^j_{m1,m2}(theta) = Re[i^(m2-m1) sum_k D^j_{k,m1} D^j_{k,m2} e^(ik theta)]
+// with D^j = d^j(pi/2), which is accurate to the last bits of the largest
+// values but not of small values
+static void ref_dl(const long double* tab, int j, int m1, int m2,
+                   long double theta, long double* d, long double* dd)
+{
+    int k, p;
+    long double c, s, ck, sk, t;
+
+    if(abs(m1) > j || abs(m2) > j)
+    {
+        *d = *dd = 0;
+        return;
+    }
+
+    if(theta > 0 && theta < PI && ref_dl_sum(j, m1, m2, theta, d, dd) < 16)
+        return;
+
+    c = s = ck = sk = 0;
+    for(k = -j; k <= j; ++k)
+    {
+        t = DELTA(tab, j, k, m1)*DELTA(tab, j, k, m2);
+        c += t*cosl(k*theta);
+        s += t*sinl(k*theta);
+        ck += k*t*cosl(k*theta);
+        sk += k*t*sinl(k*theta);
+    }
+
+    p = ((m2 - m1) % 4 + 4) % 4;
+    *d = p == 0 ? c : p == 1 ? -s : p == 2 ? -c : s;
+    *dd = p == 0 ? -sk : p == 1 ? -ck : p == 2 ? sk : ck;
+
+    // exact values at the poles, where only the derivatives for m1 = m2 +- 1
+    // and m1 = -m2 +- 1 are non-zero
+    if(theta == 0)
+    {
+        *d = m1 == m2;
+        if(abs(m1 - m2) != 1)
+            *dd = 0;
+    }
+    else if(theta == PI)
+    {
+        *d = m1 == -m2 ? (odd(j + m1) ? -1 : 1) : 0;
+        if(abs(m1 + m2) != 1)
+            *dd = 0;
+    }
+}
+
+static void test_3j_reference(double* buf, long double* ref)
+{
+    int tl1, tl2, tl3, tm1, tm2, tm3, tmin, tmax, jmin, jmax, n, i, ier;
+    double l1min, l1max, m2min, m2max;
+    struct check c, cs, ci, cn, cm, cmi, cmn, cb, cg;
+    double* buf2 = buf + 8*REF_3J+4;
+
+    check_begin(&c, "3jj reference", 16);
+    check_begin(&ci, "3jj_twoj == 3jj", 0);
+    check_begin(&cn, "3jj_int == 3jj", 0);
+    check_begin(&cs, "3j_single reference", 256);
+    for(tl2 = 0; tl2 <= 2*REF_3J; ++tl2)
+    for(tl3 = 0; tl3 <= 2*REF_3J; ++tl3)
+    for(tm2 = -tl2; tm2 <= tl2; tm2 += 2)
+    for(tm3 = -tl3; tm3 <= tl3; tm3 += 2)
+    {
+        TIMED(&c, ier = wigner_3jj(0.5*tl2, 0.5*tl3, 0.5*tm2, 0.5*tm3,
+                                   &l1min, &l1max, buf, 4*REF_3J+2));
+        if(ier)
+            continue;
+        tm1 = -tm2 - tm3;
+        n = (int)(l1max - l1min) + 1;
+        for(i = 0; i < n; ++i)
+            ref[i] = ref_3j((int)(2*l1min)+2*i, tl2, tl3, tm1, tm2, tm3);
+        check_row(&c, n, buf, ref);
+
+        TIMED(&ci, ier = wigner_3jj_twoj(tl2, tl3, tm2, tm3, &tmin, &tmax,
+                                         buf2, 4*REF_3J+2));
+        if(ier || tmin != 2*l1min || tmax != 2*l1max)
+            nfail += 1;
+        for(i = 0; i < n; ++i)
+            check_add(&ci, buf2[i], buf[i], 0);
+
+        if(!odd(tl2) && !odd(tl3) && !odd(tm2) && !odd(tm3))
+        {
+            TIMED(&cn, ier = wigner_3jj_int(tl2/2, tl3/2, tm2/2, tm3/2, &jmin,
+                                            &jmax, buf2, 4*REF_3J+2));
+            if(ier || jmin != l1min || jmax != l1max)
+                nfail += 1;
+            for(i = 0; i < n; ++i)
+                check_add(&cn, buf2[i], buf[i], 0);
+        }
+
+        for(i = 0; i < n; ++i)
+        {
+            TIMED(&cs, buf2[i] = wigner_3j_single(l1min+i, 0.5*tl2, 0.5*tl3,
+                                                  0.5*tm1, 0.5*tm2,
+                                                  0.5*tm3));
+        }
+        check_row(&cs, n, buf2, ref);
+    }
+    check_end(&c);
+    check_end(&ci);
+    check_end(&cn);
+    check_end(&cs);
+
+    check_begin(&cm, "3jm reference", 128);
+    check_begin(&cmi, "3jm_twoj == 3jm", 0);
+    check_begin(&cmn, "3jm_int == 3jm", 0);
+    for(tl1 = 0; tl1 <= 2*REF_3J; ++tl1)
+    for(tl2 = 0; tl2 <= 2*REF_3J; ++tl2)
+    for(tl3 = abs(tl1-tl2); tl3 <= tl1+tl2 && tl3 <= 2*REF_3J; tl3 += 2)
+    for(tm1 = -tl1; tm1 <= tl1; tm1 += 2)
+    {
+        TIMED(&cm, ier = wigner_3jm(0.5*tl1, 0.5*tl2, 0.5*tl3, 0.5*tm1,
+                                    &m2min, &m2max, buf, 4*REF_3J+2));
+        if(ier)
+            continue;
+        n = (int)(m2max - m2min) + 1;
+        for(i = 0; i < n; ++i)
+        {
+            tm2 = (int)(2*m2min) + 2*i;
+            ref[i] = ref_3j(tl1, tl2, tl3, tm1, tm2, -tm1-tm2);
+        }
+        check_row(&cm, n, buf, ref);
+
+        TIMED(&cmi, ier = wigner_3jm_twoj(tl1, tl2, tl3, tm1, &tmin, &tmax,
+                                          buf2, 4*REF_3J+2));
+        if(ier || tmin != 2*m2min || tmax != 2*m2max)
+            nfail += 1;
+        for(i = 0; i < n; ++i)
+            check_add(&cmi, buf2[i], buf[i], 0);
+
+        if(!odd(tl1) && !odd(tl2) && !odd(tl3) && !odd(tm1))
+        {
+            TIMED(&cmn, ier = wigner_3jm_int(tl1/2, tl2/2, tl3/2, tm1/2, &jmin,
+                                             &jmax, buf2, 4*REF_3J+2));
+            if(ier || jmin != m2min || jmax != m2max)
+                nfail += 1;
+            for(i = 0; i < n; ++i)
+                check_add(&cmn, buf2[i], buf[i], 0);
+        }
+    }
+    check_end(&cm);
+    check_end(&cmi);
+    check_end(&cmn);
+
+    // blocks for integer l, stored as out[(l1+m1)*(2*l2+1) + (l2+m2)]
+    check_begin(&cb, "3j_block reference", 64);
+    check_begin(&cg, "clebsch_gordan_block ref", 64);
+    for(tl1 = 0; tl1 <= REF_3J; ++tl1)
+    for(tl2 = 0; tl2 <= REF_3J; ++tl2)
+    for(tl3 = abs(tl1-tl2); tl3 <= tl1+tl2 && tl3 <= REF_3J; ++tl3)
+    {
+        n = (2*tl1+1)*(2*tl2+1);
+        for(tm1 = -tl1; tm1 <= tl1; ++tm1)
+            for(tm2 = -tl2; tm2 <= tl2; ++tm2)
+                ref[(tl1+tm1)*(2*tl2+1) + tl2+tm2] =
+                    ref_3j(2*tl1, 2*tl2, 2*tl3, 2*tm1, 2*tm2, -2*tm1-2*tm2);
+        TIMED(&cb, wigner_3j_block(tl1, tl2, tl3, buf));
+        check_row(&cb, n, buf, ref);
+
+        for(tm1 = -tl1; tm1 <= tl1; ++tm1)
+            for(tm2 = -tl2; tm2 <= tl2; ++tm2)
+                ref[(tl1+tm1)*(2*tl2+1) + tl2+tm2] =
+                    (odd(tl1-tl2+tm1+tm2) ? -1 : 1)*sqrtl(2*tl3+1)
+                    * ref_3j(2*tl1, 2*tl2, 2*tl3, 2*tm1, 2*tm2, -2*tm1-2*tm2)
+                    * (abs(tm1+tm2) <= tl3);
+        TIMED(&cg, clebsch_gordan_block(tl1, tl2, tl3, buf));
+        check_row(&cg, n, buf, ref);
+    }
+    check_end(&cb);
+    check_end(&cg);
+}
+
+static void test_6j_reference(double* buf, long double* ref)
+{
+    int t2, t3, t4, t5, t6, tmin, tmax, jmin, jmax, n, i, ier;
+    double l1min, l1max;
+    struct check c, ci, cn, cs;
+    double* buf2 = buf + 8*REF_6J+4;
+
+    check_begin(&c, "6j reference", 64);
+    check_begin(&ci, "6j_twoj == 6j", 0);
+    check_begin(&cn, "6j_int == 6j", 0);
+    check_begin(&cs, "6j_single reference", 128);
+    for(t2 = 0; t2 <= 2*REF_6J; ++t2)
+    for(t3 = 0; t3 <= 2*REF_6J; ++t3)
+    for(t4 = 0; t4 <= 2*REF_6J; ++t4)
+    for(t5 = 0; t5 <= 2*REF_6J; ++t5)
+    for(t6 = 0; t6 <= 2*REF_6J; ++t6)
+    {
+        if(!ref_istri(t4, t2, t6) || !ref_istri(t4, t5, t3))
+            continue;
+        TIMED(&c, ier = wigner_6j(0.5*t2, 0.5*t3, 0.5*t4, 0.5*t5, 0.5*t6,
+                                  &l1min, &l1max, buf, 4*REF_6J+2));
+        if(ier)
+            continue;
+        n = (int)(l1max - l1min) + 1;
+        for(i = 0; i < n; ++i)
+            ref[i] = ref_6j((int)(2*l1min)+2*i, t2, t3, t4, t5, t6);
+        check_row(&c, n, buf, ref);
+
+        TIMED(&ci, ier = wigner_6j_twoj(t2, t3, t4, t5, t6, &tmin, &tmax,
+                                        buf2, 4*REF_6J+2));
+        if(ier || tmin != 2*l1min || tmax != 2*l1max)
+            nfail += 1;
+        for(i = 0; i < n; ++i)
+            check_add(&ci, buf2[i], buf[i], 0);
+
+        if(!odd(t2) && !odd(t3) && !odd(t4) && !odd(t5) && !odd(t6))
+        {
+            TIMED(&cn, ier = wigner_6j_int(t2/2, t3/2, t4/2, t5/2, t6/2, &jmin,
+                                           &jmax, buf2, 4*REF_6J+2));
+            if(ier || jmin != l1min || jmax != l1max)
+                nfail += 1;
+            for(i = 0; i < n; ++i)
+                check_add(&cn, buf2[i], buf[i], 0);
+        }
+
+        for(i = 0; i < n; ++i)
+        {
+            TIMED(&cs, buf2[i] = wigner_6j_single(l1min+i, 0.5*t2, 0.5*t3,
+                                                  0.5*t4, 0.5*t5, 0.5*t6));
+        }
+        check_row(&cs, n, buf2, ref);
+    }
+    check_end(&c);
+    check_end(&ci);
+    check_end(&cn);
+    check_end(&cs);
+}
+
+static void test_dl_reference(double* buf, long double* ref)
+{
+    static const double angles[] = {
+        0, 1e-8, 1e-2, 0.5, 1, 1.5707963267948966, 2, 3.1, 3.1415916535897931,
+        3.1415926535897931 };
+    const int nangles = sizeof(angles)/sizeof(*angles);
+    const int n = REF_DL+1;
+
+    int m1, m2, k, l;
+    double x;
+    long double t;
+    long double* tab;
+    long double* dref;
+    double* d2;
+    double* dd;
+    struct wigner_dl_state st;
+    struct check c, cp, cd, cdd, cs, cg, cm;
+    int mm1[4], mm2[4];
+
+    tab = ref_delta();
+    if(!tab)
+    {
+        nfail += 1;
+        return;
+    }
+    dref = ref + n;
+    d2 = buf + n;
+    dd = buf + 2*n;
+
+    check_begin(&c, "dl reference", 32);
+    check_begin(&cp, "legendre_pl reference", 2);
+    check_begin(&cd, "dl_deriv reference", 32);
+    check_begin(&cdd, "dl_deriv derivative ref", 8);
+    check_begin(&cs, "dl_state reference", 32);
+    check_begin(&cg, "dl_segmented reference", 32);
+    check_begin(&cm, "dl_multi reference", 32);
+    for(m1 = -8; m1 <= 8; ++m1)
+    {
+        for(m2 = -8; m2 <= 8; ++m2)
+        {
+            for(k = 0; k < nangles; ++k)
+            {
+                for(l = 0; l < n; ++l)
+                    ref_dl(tab, l, m1, m2, angles[k], &ref[l], &dref[l]);
+
+                TIMED(&c, wigner_dl(0, REF_DL, m1, m2, angles[k], buf));
+                check_row_dl(&c, n, buf, ref, angles[k]);
+
+                // reference at the angle of the rounded argument
+                if(m1 == 0 && m2 == 0)
+                {
+                    x = cos(angles[k]);
+                    for(l = 0; l < n; ++l)
+                        ref_dl(tab, l, 0, 0, acosl(x), &ref[2*n+l], &t);
+                    TIMED(&cp, legendre_pl(0, REF_DL, x, buf));
+                    check_row_dl(&cp, n, buf, ref+2*n, angles[k]);
+                }
+
+                TIMED(&cd, wigner_dl_deriv(0, REF_DL, m1, m2, angles[k], buf,
+                                           dd));
+                check_row_dl(&cd, n, buf, ref, angles[k]);
+
+                // the reference derivative is taken at pi, and not at the
+                // rounded angle, where it differs by about l^2 (pi - theta)
+                if(angles[k] != PI)
+                    check_row_dl(&cdd, n, dd, dref, angles[k]);
+
+                // chunks of uneven length
+                TIMED(&cs, wigner_dl_init(&st, m1, m2, angles[k]);
+                           for(l = 0; l < n; l += 7)
+                               wigner_dl_advance(&st, l+7 < n ? 7 : n-l,
+                                                 buf+l));
+                check_row_dl(&cs, n, buf, ref, angles[k]);
+
+                TIMED(&cg, wigner_dl_segmented(0, REF_DL, m1, m2, angles[k],
+                                               buf));
+                check_row_dl(&cg, n, buf, ref, angles[k]);
+
+                // together with the spins of the two-point functions
+                mm1[0] = m1, mm2[0] = m2;
+                mm1[1] = 0, mm2[1] = 0;
+                mm1[2] = 2, mm2[2] = -2;
+                mm1[3] = -m2, mm2[3] = m1;
+                TIMED(&cm, wigner_dl_multi(0, REF_DL, 4, mm1, mm2, angles[k],
+                                           0, d2));
+                check_row_dl(&cm, n, d2, ref, angles[k]);
+                for(l = 0; l < n; ++l)
+                    ref_dl(tab, l, -m2, m1, angles[k], &ref[l], &dref[l]);
+                check_row_dl(&cm, n, d2+3*n, ref, angles[k]);
+            }
+        }
+    }
+    check_end(&c);
+    check_end(&cp);
+    check_end(&cd);
+    check_end(&cdd);
+    check_end(&cs);
+    check_end(&cg);
+    check_end(&cm);
+
+    free(tab);
+}
+
+// largest l of the identity checks
+#define ID_LMAX 5000
+
+// rows of 3j symbols for the identity checks: l2, l3, m2, m3
+static const double id_3j[][4] = {
+    { 50, 50, 0, 0 }, { 50, 20, 2, -2 }, { 300, 300, 1, 5 },
+    { 300, 150, 150, -50 }, { 1000, 1000, 0, 0 }, { 1000, 10, 2, -2 },
+    { 1000, 500, 1000, -500 }, { 2500, 2500, 2, 2 }, { 2500, 1250.5, 3, -4.5 },
+    { 2500, 2500, 2500, -2500 }, { 99.5, 1000, 0.5, 0 },
+};
+
+static void test_3j_identities(double* buf)
+{
+    const int nrows = sizeof(id_3j)/sizeof(*id_3j);
+
+    int i, j, n, ier;
+    double l1, l1min, l1max, m2min, m2max;
+    long double s;
+    struct check c, cm;
+
+    check_begin(&c, "3jj normalisation", 64);
+    check_begin(&cm, "3jm normalisation", 64);
+    for(i = 0; i < nrows; ++i)
+    {
+        // sum_l1 (2 l1 + 1) 3j^2 = 1
+        TIMED(&c, ier = wigner_3jj(id_3j[i][0], id_3j[i][1], id_3j[i][2],
+                                   id_3j[i][3], &l1min, &l1max, buf,
+                                   2*ID_LMAX+2));
+        if(ier)
+        {
+            nfail += 1;
+            continue;
+        }
+        n = (int)(l1max - l1min) + 1;
+        s = 0;
+        for(j = 0; j < n; ++j)
+            s += (2*(l1min+j)+1)*(long double)buf[j]*buf[j];
+        check_add(&c, (double)s, 1, 1);
+
+        // sum_m2 3j^2 = 1/(2 l1 + 1), for l1 in the middle of the row
+        l1 = l1min + (n/2);
+        TIMED(&cm, ier = wigner_3jm(l1, id_3j[i][0], id_3j[i][1],
+                                    -id_3j[i][2]-id_3j[i][3], &m2min, &m2max,
+                                    buf, 2*ID_LMAX+2));
+        if(ier)
+        {
+            nfail += 1;
+            continue;
+        }
+        n = (int)(m2max - m2min) + 1;
+        s = 0;
+        for(j = 0; j < n; ++j)
+            s += (long double)buf[j]*buf[j];
+        check_add(&cm, (double)((2*l1+1)*s), 1, 1);
+    }
+    check_end(&c);
+    check_end(&cm);
+}
+
+// rows of 6j symbols for the identity checks: l2, l3, l4, l5, l6
+static const double id_6j[][5] = {
+    { 50, 50, 50, 50, 50 }, { 500, 800, 300, 700, 600 },
+    { 1000, 1000, 1000, 1000, 1000 }, { 1000.5, 999.5, 700, 500.5, 600.5 },
+    { 2000, 2500, 10, 2495, 2003 }, { 100, 2400, 2450, 2420, 2480 },
+};
+
+static void test_6j_identities(double* buf)
+{
+    const int nrows = sizeof(id_6j)/sizeof(*id_6j);
+
+    int i, j, n, ier;
+    double l1min, l1max;
+    long double s;
+    struct check c;
+
+    check_begin(&c, "6j normalisation", 64);
+    for(i = 0; i < nrows; ++i)
+    {
+        // sum_l1 (2 l1 + 1) (2 l4 + 1) 6j^2 = 1
+        TIMED(&c, ier = wigner_6j(id_6j[i][0], id_6j[i][1], id_6j[i][2],
+                                  id_6j[i][3], id_6j[i][4], &l1min, &l1max,
+                                  buf, 2*ID_LMAX+2));
+        if(ier)
+        {
+            nfail += 1;
+            continue;
+        }
+        n = (int)(l1max - l1min) + 1;
+        s = 0;
+        for(j = 0; j < n; ++j)
+            s += (2*(l1min+j)+1)*(long double)buf[j]*buf[j];
+        check_add(&c, (double)((2*id_6j[i][2]+1)*s), 1, 1);
+    }
+    check_end(&c);
+}
+
+// rows of 3j and 6j symbols for the single values, with l large enough for
+// the recursion between the closed-form values at the ends of the row, and
+// forbidden regions at the upper ends of some rows of 6j symbols
+static const double single_3j[][4] = {
+    { 40, 40, 0, 0 }, { 60, 45, 2, -1 }, { 100, 100, 0, 0 },
+    { 120.5, 80, -3.5, 7 }, { 200, 150, 10, -20 }, { 200, 200, 200, -200 },
+    { 200, 5, 1, 2 },
+};
+static const double single_6j[][5] = {
+    { 40, 40, 40, 40, 40 }, { 60, 70, 50, 80, 65 },
+    { 100, 100, 100, 100, 100 }, { 150.5, 120.5, 90, 100.5, 110.5 },
+    { 200, 190, 30, 185, 195 }, { 112, 168, 43, 132, 152 },
+};
+
+// the closed forms at the ends of the rows are exponentials of sums of log
+// factorials, and are rounded relative to the sum J of the l; errors are
+// hence given in units of J times the largest value of the row
+static void test_single(double* buf)
+{
+    const int n3j = sizeof(single_3j)/sizeof(*single_3j);
+    const int n6j = sizeof(single_6j)/sizeof(*single_6j);
+
+    int i, j, n, ier;
+    double l1min, l1max, m1, x, scale;
+    struct check c3, c6;
+
+    check_begin(&c3, "3j_single == 3jj", 16);
+    for(i = 0; i < n3j; ++i)
+    {
+        ier = wigner_3jj(single_3j[i][0], single_3j[i][1], single_3j[i][2],
+                         single_3j[i][3], &l1min, &l1max, buf, 2*ID_LMAX+2);
+        if(ier)
+        {
+            nfail += 1;
+            continue;
+        }
+        n = (int)(l1max - l1min) + 1;
+        m1 = -single_3j[i][2] - single_3j[i][3];
+        scale = 0;
+        for(j = 0; j < n; ++j)
+            scale = fmax(scale, fabs(buf[j]));
+        scale *= l1max + single_3j[i][0] + single_3j[i][1];
+        for(j = 0; j < n; ++j)
+        {
+            TIMED(&c3, x = wigner_3j_single(l1min+j, single_3j[i][0],
+                                            single_3j[i][1], m1,
+                                            single_3j[i][2],
+                                            single_3j[i][3]));
+            check_add(&c3, x, buf[j], scale);
+        }
+    }
+    check_end(&c3);
+
+    check_begin(&c6, "6j_single == 6j", 16);
+    for(i = 0; i < n6j; ++i)
+    {
+        ier = wigner_6j(single_6j[i][0], single_6j[i][1], single_6j[i][2],
+                        single_6j[i][3], single_6j[i][4], &l1min, &l1max, buf,
+                        2*ID_LMAX+2);
+        if(ier)
+        {
+            nfail += 1;
+            continue;
+        }
+        n = (int)(l1max - l1min) + 1;
+        scale = 0;
+        for(j = 0; j < n; ++j)
+            scale = fmax(scale, fabs(buf[j]));
+        scale *= l1max + single_6j[i][0] + single_6j[i][1] + single_6j[i][2]
+                 + single_6j[i][3] + single_6j[i][4];
+        for(j = 0; j < n; ++j)
+        {
+            TIMED(&c6, x = wigner_6j_single(l1min+j, single_6j[i][0],
+                                            single_6j[i][1], single_6j[i][2],
+                                            single_6j[i][3],
+                                            single_6j[i][4]));
+            check_add(&c6, x, buf[j], scale);
+        }
+    }
+    check_end(&c6);
+}
+
+// rows of the batches with invalid arguments, for which wigner_3jj and
+// wigner_6j return before the limits of l1 are known
+static const double bad_3j[4] = { 10, 10, 12, 0 };
+static const double bad_6j[5] = { 10, 10, 10, 10, 10.5 };
+
+static void test_batch(double* buf)
+{
+    enum { N3J = sizeof(id_3j)/sizeof(*id_3j), N6J = sizeof(id_6j)/sizeof(*id_6j) };
+    enum { NB = (N3J > N6J ? N3J : N6J) + 1 };
+
+    double a[5][NB];
+    size_t off[NB + 1];
+    double l1min[NB], l1, l2;
+    int i, j, n, ier[NB];
+    double* rows;
+    struct check c;
+
+    check_begin(&c, "3jj_batch == 3jj", 0);
+    for(i = 0; i < N3J; ++i)
+        for(j = 0; j < 4; ++j)
+            a[j][i] = id_3j[i][j];
+    for(j = 0; j < 4; ++j)
+        a[j][N3J] = bad_3j[j];
+    rows = malloc(wigner_3jj_batch_size(N3J+1, a[0], a[1], a[2], a[3], off)
+                  * sizeof(double));
+    if(!rows)
+    {
+        nfail += 1;
+        return;
+    }
+    TIMED(&c, n = wigner_3jj_batch(N3J+1, a[0], a[1], a[2], a[3], off, l1min,
+                                   rows, ier));
+    check_add(&c, n, 1, 0);
+    for(i = 0; i < N3J; ++i)
+    {
+        wigner_3jj(a[0][i], a[1][i], a[2][i], a[3][i], &l1, &l2, buf,
+                   2*ID_LMAX+2);
+        n = (int)(l2 - l1) + 1;
+        check_add(&c, l1min[i], l1, 0);
+        check_add(&c, ier[i], 0, 0);
+        check_add(&c, (double)(off[i+1] - off[i]), n, 0);
+        for(j = 0; j < n; ++j)
+            check_add(&c, rows[off[i]+j], buf[j], 0);
+    }
+    check_add(&c, l1min[N3J], 0, 0);
+    check_add(&c, ier[N3J], 1, 0);
+    check_add(&c, (double)(off[N3J+1] - off[N3J]), 0, 0);
+    free(rows);
+    check_end(&c);
+
+    check_begin(&c, "6j_batch == 6j", 0);
+    for(i = 0; i < N6J; ++i)
+        for(j = 0; j < 5; ++j)
+            a[j][i] = id_6j[i][j];
+    for(j = 0; j < 5; ++j)
+        a[j][N6J] = bad_6j[j];
+    rows = malloc(wigner_6j_batch_size(N6J+1, a[0], a[1], a[2], a[3], a[4],
+                                       off)*sizeof(double));
+    if(!rows)
+    {
+        nfail += 1;
+        return;
+    }
+    TIMED(&c, n = wigner_6j_batch(N6J+1, a[0], a[1], a[2], a[3], a[4], off,
+                                  l1min, rows, ier));
+    check_add(&c, n, 1, 0);
+    for(i = 0; i < N6J; ++i)
+    {
+        wigner_6j(a[0][i], a[1][i], a[2][i], a[3][i], a[4][i], &l1, &l2, buf,
+                  2*ID_LMAX+2);
+        n = (int)(l2 - l1) + 1;
+        check_add(&c, l1min[i], l1, 0);
+        check_add(&c, ier[i], 0, 0);
+        check_add(&c, (double)(off[i+1] - off[i]), n, 0);
+        for(j = 0; j < n; ++j)
+            check_add(&c, rows[off[i]+j], buf[j], 0);
+    }
+    check_add(&c, l1min[N6J], 0, 0);
+    check_add(&c, ier[N6J], 1, 0);
+    check_add(&c, (double)(off[N6J+1] - off[N6J]), 0, 0);
+    free(rows);
+    check_end(&c);
+}
+
+// external scheduler for the tests, which runs the tasks in reverse order
+static void sched_reverse(void* sched, int ntasks, wigner_task* task,
+                          void* arg)
+{
+    int i;
+
+    *(int*)sched += ntasks;
+    for(i = ntasks-1; i >= 0; --i)
+        task(arg, i);
+}
+
+// the execution contexts of the tests: one thread, four threads, and three
+// workers of the external scheduler, which counts the tasks in ntasks
+#define NEXEC 3
+
+static void exec_contexts(struct wigner_exec* exec, int* ntasks)
+{
+    wigner_exec_init(&exec[0], 1);
+    wigner_exec_init(&exec[1], 4);
+    *ntasks = 0;
+    wigner_exec_external(&exec[2], 3, sched_reverse, ntasks);
+}
+
+// task that marks that it ran, and fails for the task given in arg
+static int try_mark(void* arg, int task)
+{
+    int* ran = arg;
+
+    ran[task+1] = 1;
+    return task == ran[0];
+}
+
+// a call of a parallel routine on an execution context, which stores its
+// results in out and returns its error code
+typedef int exec_call(void* arg, const struct wigner_exec* exec, double* out);
+
+// the n results of call on every execution context, which must be identical
+// bit for bit to those of the default context, which are stored in ref
+static void check_exec(struct check* c, exec_call* call, void* arg, size_t n,
+                       double* ref, double* out)
+{
+    struct wigner_exec exec[NEXEC];
+    size_t i;
+    int k, ier, ntasks;
+
+    exec_contexts(exec, &ntasks);
+    check_add(c, call(arg, NULL, ref), 0, 0);
+    for(k = 0; k < NEXEC; ++k)
+    {
+        TIMED(c, ier = call(arg, &exec[k], out));
+        check_add(c, ier, 0, 0);
+        for(i = 0; i < n; ++i)
+            check_add(c, out[i], ref[i], 0);
+    }
+    check_add(c, ntasks > 0, 1, 0);
+}
+
+// number of rows and largest l of the d functions of the execution context
+// checks
+#define EXEC_N 3000
+#define EXEC_LMAX 500
+
+// number of Gauss-Legendre nodes, and largest l of the segmented row, of the
+// execution context checks
+#define EXEC_GL 3000
+#define EXEC_SEG 40000
+
+static void test_exec(void)
+{
+    static const char* names[NEXEC] = {
+        "3jj_batch_exec (1 thread)",
+        "3jj_batch_exec (4 threads)",
+        "3jj_batch_exec (external)",
+    };
+
+    struct wigner_exec exec[NEXEC];
+    double* a;
+    double* rows;
+    double* ref;
+    size_t* off;
+    double th[64];
+    int ran[64];
+    int i, k, nerr, nref, ntasks;
+    size_t n;
+    struct check c;
+
+    exec_contexts(exec, &ntasks);
+
+    // rows of very different lengths, and some with invalid arguments
+    a = malloc(4*EXEC_N*sizeof(double));
+    off = malloc((EXEC_N+1)*sizeof(size_t));
+    if(!a || !off)
+    {
+        nfail += 1;
+        free(a);
+        free(off);
+        return;
+    }
+    for(i = 0; i < EXEC_N; ++i)
+    {
+        a[i] = (i*7919) % 1000;
+        a[EXEC_N+i] = (i % 17 == 0) ? (i*31) % 1000 : i % 23;
+        a[2*EXEC_N+i] = (i % 5) - 2;
+        a[3*EXEC_N+i] = (i % 101 == 0) ? 0.5 : (i % 3) - 1;
+    }
+    n = wigner_3jj_batch_size(EXEC_N, a, a+EXEC_N, a+2*EXEC_N, a+3*EXEC_N,
+                              off);
+    rows = malloc(2*n*sizeof(double));
+    if(!rows)
+    {
+        nfail += 1;
+        free(a);
+        free(off);
+        return;
+    }
+    ref = rows + n;
+    nref = wigner_3jj_batch(EXEC_N, a, a+EXEC_N, a+2*EXEC_N, a+3*EXEC_N, off,
+                            NULL, ref, NULL);
+
+    for(k = 0; k < NEXEC; ++k)
+    {
+        check_begin(&c, names[k], 0);
+        TIMED(&c, nerr = wigner_3jj_batch_exec(EXEC_N, a, a+EXEC_N,
+                                               a+2*EXEC_N, a+3*EXEC_N, off,
+                                               NULL, rows, NULL, &exec[k]));
+        check_add(&c, nerr, nref, 0);
+        for(i = 0; (size_t)i < n; ++i)
+            check_add(&c, rows[i], ref[i], 0);
+        if(k == 2)
+            check_add(&c, ntasks > 3, 1, 0);
+        check_end(&c);
+    }
+
+    free(rows);
+    free(off);
+    free(a);
+
+    // d functions for many angles
+    rows = malloc(2*64*(EXEC_LMAX+1)*sizeof(double));
+    if(!rows)
+    {
+        nfail += 1;
+        return;
+    }
+    ref = rows + 64*(EXEC_LMAX+1);
+    for(i = 0; i < 64; ++i)
+    {
+        th[i] = PI*(i+0.5)/64;
+        wigner_dl(0, EXEC_LMAX, 2, -3, th[i], ref + i*(EXEC_LMAX+1));
+    }
+    check_begin(&c, "dl_batch == dl", 0);
+    for(k = 0; k < NEXEC; ++k)
+    {
+        TIMED(&c, wigner_dl_batch(0, EXEC_LMAX, 2, -3, 64, th, rows, &exec[k]));
+        for(i = 0; i < 64*(EXEC_LMAX+1); ++i)
+            check_add(&c, rows[i], ref[i], 0);
+    }
+    check_end(&c);
+    free(rows);
+
+    rows = malloc(2*(EXEC_SEG+1)*sizeof(double));
+    if(!rows)
+    {
+        nfail += 1;
+        return;
+    }
+    ref = rows + EXEC_SEG+1;
+
+    // Gauss-Legendre nodes and weights, which do not depend on the threads
+    check_begin(&c, "gauss_legendre_exec", 0);
+    gauss_legendre(EXEC_GL, ref, ref + EXEC_GL);
+    for(k = 0; k < NEXEC; ++k)
+    {
+        TIMED(&c, gauss_legendre_exec(EXEC_GL, rows, rows + EXEC_GL,
+                                      &exec[k]));
+        for(i = 0; i < 2*EXEC_GL; ++i)
+            check_add(&c, rows[i], ref[i], 0);
+    }
+    check_end(&c);
+
+    // a long row in as many segments as the context has threads, against
+    // the serial recurrence of a context with one thread
+    check_begin(&c, "dl_segmented_exec", 128);
+    wigner_dl_segmented_exec(0, EXEC_SEG, 2, -3, 1., ref, &exec[0]);
+    for(k = 1; k < NEXEC; ++k)
+    {
+        ntasks = 0;
+        TIMED(&c, wigner_dl_segmented_exec(0, EXEC_SEG, 2, -3, 1., rows,
+                                           &exec[k]));
+        for(i = 0; i <= EXEC_SEG; ++i)
+            check_add(&c, rows[i], ref[i], 1);
+        if(k == 2)
+            check_add(&c, ntasks, 2*3-1, 0);
+    }
+    check_end(&c);
+
+    free(rows);
+
+    // tasks that can fail, which all run, and whose failure is reported
+    check_begin(&c, "exec_try", 0);
+    for(k = 0; k < NEXEC; ++k)
+    {
+        for(nerr = -1; nerr < 63; nerr += 21)
+        {
+            ran[0] = nerr;
+            for(i = 1; i <= 63; ++i)
+                ran[i] = 0;
+            check_add(&c, wigner_exec_try(&exec[k], 63, try_mark, ran),
+                      nerr >= 0, 0);
+            for(i = 1; i <= 63; ++i)
+                check_add(&c, ran[i], 1, 0);
+        }
+    }
+    check_add(&c, wigner_exec_try(NULL, 0, try_mark, ran), 0, 0);
+    check_end(&c);
+}
+
+// instrumentation counters of the rows of a batch on the threads of an
+// execution context, which are all seen by the caller, if the library
+// collects them
+static void test_stats(void)
+{
+    enum { N3J = sizeof(id_3j)/sizeof(*id_3j) };
+
+    struct wigner_exec exec[2];
+    struct wigner_stats ref, st;
+    double a[4][N3J];
+    size_t off[N3J+1];
+    double l1min, l1max;
+    double* rows;
+    int i, j, k, ntasks;
+    struct check c;
+
+    if(wigner_stats_get(WIGNER_STATS_3JJ, &ref) != 0)
+        return;
+
+    for(i = 0; i < N3J; ++i)
+        for(j = 0; j < 4; ++j)
+            a[j][i] = id_3j[i][j];
+    rows = malloc(wigner_3jj_batch_size(N3J, a[0], a[1], a[2], a[3], off)
+                  * sizeof(double));
+    if(!rows)
+    {
+        nfail += 1;
+        return;
+    }
+
+    wigner_stats_reset();
+    for(i = 0; i < N3J; ++i)
+        wigner_3jj(a[0][i], a[1][i], a[2][i], a[3][i], &l1min, &l1max,
+                   rows + off[i], (int)(off[i+1] - off[i]));
+    wigner_stats_get(WIGNER_STATS_3JJ, &ref);
+
+    wigner_exec_init(&exec[0], 4);
+    ntasks = 0;
+    wigner_exec_external(&exec[1], 3, sched_reverse, &ntasks);
+    check_begin(&c, "wigner_stats of exec", 0);
+    check_add(&c, (double)ref.calls, N3J, 0);
+    check_add(&c, (double)ref.coefs, (double)off[N3J], 0);
+    for(k = 0; k < 2; ++k)
+    {
+        wigner_stats_reset();
+        wigner_3jj_batch_exec(N3J, a[0], a[1], a[2], a[3], off, NULL, rows,
+                              NULL, &exec[k]);
+        wigner_stats_get(WIGNER_STATS_3JJ, &st);
+        check_add(&c, (double)st.calls, (double)ref.calls, 0);
+        check_add(&c, (double)st.coefs, (double)ref.coefs, 0);
+        check_add(&c, (double)st.rescales, (double)ref.rescales, 0);
+        check_add(&c, (double)st.fwd_steps, (double)ref.fwd_steps, 0);
+        check_add(&c, (double)st.bwd_steps, (double)ref.bwd_steps, 0);
+        check_add(&c, (double)st.nobac, (double)ref.nobac, 0);
+        check_add(&c, (double)st.zeroed, (double)ref.zeroed, 0);
+    }
+    check_end(&c);
+    wigner_stats_reset();
+
+    free(rows);
+}
+
+// largest l of the packed tensor of 3j symbols with m = 0
+#define T3J_LMAX 400
+
+// binned sums of squared 3j symbols against the sums over the packed tensor
+// arguments of wigner_3j000_binned on an execution context
+struct binned_args
+{
+    int nbins;
+    const int* edges;
+    const double* w[3];
+};
+
+static int binned_call(void* arg, const struct wigner_exec* exec, double* out)
+{
+    const struct binned_args* b = arg;
+
+    return wigner_3j000_binned(b->nbins, b->edges, b->w[0], b->w[1], b->w[2],
+                               out, exec);
+}
+
+static void test_3j000_binned(const double* t)
+{
+    enum { NB = 5 };
+    static const int edges[NB+1] = { 2, 10, 31, 32, 70, 121 };
+
+    struct binned_args b;
+    double w[3][121], out[NB*NB*NB], out2[NB*NB*NB], x;
+    long double ref[NB*NB*NB], sum[NB*NB*NB];
+    int i, k, l1, l2, l3, b1, b2, b3, ier;
+    struct check c, ce;
+
+    for(i = 0; i < 121; ++i)
+    {
+        w[0][i] = 2*i+1;
+        w[1][i] = 1./(i+1);
+        w[2][i] = cos(i);
+    }
+
+    check_begin(&c, "3j000_binned reference", 16);
+    TIMED(&c, ier = wigner_3j000_binned(NB, edges, w[0], w[1], w[2], out,
+                                        NULL));
+    check_add(&c, ier, 0, 0);
+    for(i = 0; i < NB*NB*NB; ++i)
+        ref[i] = sum[i] = 0;
+    for(b1 = 0; b1 < NB; ++b1)
+    for(b2 = 0; b2 < NB; ++b2)
+    for(b3 = 0; b3 < NB; ++b3)
+    {
+        k = (b1*NB+b2)*NB+b3;
+        for(l1 = edges[b1]; l1 < edges[b1+1]; ++l1)
+        for(l2 = edges[b2]; l2 < edges[b2+1]; ++l2)
+        for(l3 = edges[b3]; l3 < edges[b3+1]; ++l3)
+        {
+            x = wigner_3j000_get(T3J_LMAX, t, l1, l2, l3);
+            ref[k] += (long double)x*x*w[0][l1]*w[1][l2]*w[2][l3];
+            sum[k] += fabsl((long double)x*x*w[0][l1]*w[1][l2]*w[2][l3]);
+        }
+    }
+    for(i = 0; i < NB*NB*NB; ++i)
+        check_add(&c, out[i], ref[i], (double)sum[i]);
+    check_end(&c);
+
+    b.nbins = NB;
+    b.edges = edges;
+    b.w[0] = w[0];
+    b.w[1] = NULL;
+    b.w[2] = w[2];
+    check_begin(&ce, "3j000_binned exec == default", 0);
+    check_exec(&ce, binned_call, &b, NB*NB*NB, out, out2);
+    check_add(&ce, wigner_3j000_binned(2, edges+1, NULL, NULL, NULL, out2,
+                                       NULL) == 0, 1, 0);
+    check_add(&ce, wigner_3j000_binned(0, edges, NULL, NULL, NULL, out2,
+                                       NULL), 2, 0);
+    check_end(&ce);
+}
+
+static void test_3j000(double* buf, long double* ref)
+{
+    struct wigner_3j000_iter it;
+    struct check c, ci, cg;
+    int l1, l2, l3, lmin, lmax, n, k, ier;
+    size_t size;
+    const double* row;
+    double* t;
+
+    size = wigner_3j000_size(T3J_LMAX);
+    t = malloc(size*sizeof(double));
+    if(!t)
+    {
+        nfail += 1;
+        return;
+    }
+
+    check_begin(&c, "3j000 fill == 3jj", 0);
+    TIMED(&c, ier = wigner_3j000_fill(T3J_LMAX, t, NULL));
+    check_add(&c, ier, 0, 0);
+    check_begin(&ci, "3j000 index and iterator", 0);
+    check_begin(&cg, "3j000 reference", 16);
+    n = 0;
+    for(wigner_3j000_first(&it); it.l3 <= T3J_LMAX; wigner_3j000_next(&it))
+    {
+        check_add(&ci, (double)it.i, (long double)n, 0);
+        check_add(&ci, (double)wigner_3j000_index(it.l1, it.l2, it.l3),
+                  (long double)n, 0);
+        check_add(&ci, it.l1 <= it.l2 && it.l2 <= it.l3
+                       && it.l3 <= it.l1 + it.l2
+                       && !((it.l1 + it.l2 + it.l3) & 1), 1, 0);
+        n += 1;
+    }
+    check_add(&ci, (double)n, (long double)size, 0);
+
+    for(l3 = 0; l3 <= T3J_LMAX; ++l3)
+    for(l2 = (l3+1)/2; l2 <= l3; ++l2)
+    {
+        wigner_3jj_int(l2, l3, 0, 0, &lmin, &lmax, buf, 2*T3J_LMAX+1);
+        row = wigner_3j000_row(t, l2, l3, &l1, &n);
+        check_add(&ci, l1, lmin, 0);
+        for(k = 0; l1 + 2*k <= n; ++k)
+            check_add(&c, row[k], buf[2*k], 0);
+
+        // all permutations, and the symbols that are not stored
+        for(l1 = 0; l1 <= l2; ++l1)
+        {
+            if(l1 < lmin || (l1 + l2 + l3) & 1)
+            {
+                check_add(&ci, wigner_3j000_get(T3J_LMAX, t, l1, l2, l3), 0,
+                          0);
+                continue;
+            }
+            check_add(&ci, wigner_3j000_get(T3J_LMAX, t, l3, l1, l2),
+                      buf[l1-lmin], 0);
+            check_add(&ci, wigner_3j000_get(T3J_LMAX, t, l2, l3, l1),
+                      buf[l1-lmin], 0);
+        }
+
+        if(l3 <= REF_3J)
+        {
+            n = (l2 - (l3-l2))/2 + 1;
+            for(k = 0; k < n; ++k)
+                ref[k] = ref_3j(2*(l3-l2+2*k), 2*l2, 2*l3, 0, 0, 0);
+            check_row(&cg, n, row, ref);
+        }
+    }
+    check_add(&ci, wigner_3j000_get(T3J_LMAX, t, 2, T3J_LMAX, T3J_LMAX+2), 0,
+              0);
+    check_end(&c);
+    check_end(&ci);
+    check_end(&cg);
+
+    test_3j000_binned(t);
+
+    free(t);
+}
+
+// degree of the unitarity and addition checks
+#define ID_DL 500
+
+static void test_dl_identities(double* buf)
+{
+    static const int spins[] = { 0, 2, -5 };
+    static const double angles[] = { 1e-3, 1, 2.5 };
+    static const int pairs[][2] = { { 0, 0 }, { 2, -2 }, { 3, 7 } };
+
+    int i, j, k, m;
+    double a, b;
+    long double s, t;
+    double* d0 = buf;
+    double* d1 = buf + 2*ID_DL+1;
+    struct check cu, co, ca;
+
+    // sum_m2 d_{m1,m2} d_{m1',m2} = delta_{m1,m1'}
+    check_begin(&cu, "dl unitarity", 1048576);
+    check_begin(&co, "dl orthogonality", 1048576);
+    for(i = 0; i < 3; ++i)
+    {
+        for(j = 0; j < 3; ++j)
+        {
+            for(m = -ID_DL; m <= ID_DL; ++m)
+            {
+                TIMED(&cu, wigner_dl(ID_DL, ID_DL, spins[i], m, angles[j],
+                                     &d0[ID_DL+m]);
+                           wigner_dl(ID_DL, ID_DL, spins[i]+1, m, angles[j],
+                                     &d1[ID_DL+m]));
+            }
+            s = t = 0;
+            for(m = 0; m <= 2*ID_DL; ++m)
+            {
+                s += (long double)d0[m]*d0[m];
+                t += (long double)d0[m]*d1[m];
+            }
+            check_add(&cu, (double)s, 1, 1);
+            check_add(&co, (double)t, 0, 1);
+        }
+    }
+    check_end(&cu);
+    check_end(&co);
+
+    // d_{m1,m2}(a + b) = sum_k d_{m1,k}(a) d_{k,m2}(b)
+    check_begin(&ca, "dl addition theorem", 8192);
+    for(i = 0; i < 3; ++i)
+    {
+        for(j = 0; j < 3; ++j)
+        {
+            a = angles[j];
+            b = angles[(j+1)%3];
+            for(k = -ID_DL; k <= ID_DL; ++k)
+            {
+                TIMED(&ca, wigner_dl(ID_DL, ID_DL, pairs[i][0], k, a,
+                                     &d0[ID_DL+k]);
+                           wigner_dl(ID_DL, ID_DL, k, pairs[i][1], b,
+                                     &d1[ID_DL+k]));
+            }
+            s = 0;
+            for(k = 0; k <= 2*ID_DL; ++k)
+                s += (long double)d0[k]*d1[k];
+            TIMED(&ca, wigner_dl(ID_DL, ID_DL, pairs[i][0], pairs[i][1], a+b,
+                                 d0));
+            check_add(&ca, d0[0], s, 1);
+        }
+    }
+    check_end(&ca);
+}
+
+// largest l of the checks of the d function variants
+#define VAR_DL 20000
+
+// reference d^l_{m1,m2}(theta) for large l from the recurrence of the
+// specialised kernels and wigner_dl_state, evaluated in long double; the
+// argument x = cos(theta) is rounded to double as in the library, since its
+// rounding alone changes d^l by about l eps/sin(theta) near the poles
+static void ref_dl_rec(int lmax, int m1, int m2, double theta, long double* d)
+{
+    int l, lp, a, b, c, k;
+    long double u, v, x, L, d0, d1, d2, s0, s1;
+    double ud, vd;
+
+    if(abs(m1) > abs(m2))
+    {
+        if(m1 > 0)
+            lp = m1, a = m1 - m2, b = m1 + m2, c = m1 - m2;
+        else
+            lp = -m1, a = m2 - m1, b = -m1 - m2, c = 0;
+    }
+    else
+    {
+        if(m2 > 0)
+            lp = m2, a = m2 - m1, b = m1 + m2, c = 0;
+        else
+            lp = -m2, a = m1 - m2, b = -m1 - m2, c = m1 - m2;
+    }
+
+    u = sinl(0.5L*theta);
+    v = cosl(0.5L*theta);
+    ud = sin(0.5*theta);
+    vd = cos(0.5*theta);
+    x = m1 == 0 && m2 == 0 ? cos(theta) : vd*vd - ud*ud;
+
+    d0 = (odd(c) ? -1 : 1)*powl(u, a)*powl(v, b);
+    for(k = 1; k <= a; ++k)
+        d0 *= sqrtl((long double)(b+k)/k);
+
+    for(l = 0; l < lp && l <= lmax; ++l)
+        d[l] = 0;
+    if(lp <= lmax)
+        d[lp] = d0;
+
+    d1 = s1 = 0;
+    for(l = lp+1; l <= lmax; ++l)
+    {
+        L = l;
+        s0 = sqrtl((L*L - m1*m1)*(L*L - m2*m2));
+        d2 = d1;
+        d1 = d0;
+        if(l == 1)
+            d0 = x;
+        else
+            d0 = ((2*L-1)*(L*(L-1)*x - m1*m2)*d1 - L*s1*d2)/((L-1)*s0);
+        s1 = s0;
+        d[l] = d0;
+    }
+}
+
+static void test_dl_variants(double* buf, long double* ref)
+{
+    // spin pairs with specialised kernels come first
+    static const int spins[][2] = {
+        { 1, 1 }, { 2, 2 }, { 2, -2 }, { 4, -4 }, { 0, 2 }, { -1, 0 },
+        { 0, -4 }, { 3, 7 }, { -5, 2 }, { 0, 3 }, { 0, 0 } };
+    const int nspins = sizeof(spins)/sizeof(*spins);
+    const int nkernels = 7;
+
+    // the angles near the poles test the growth of the errors as l^2 where
+    // l sin(theta) < 1
+    static const double angles[] = { 0.3, 1.5, 2.9, 1e-4, 3.14159 };
+    const int nangles = sizeof(angles)/sizeof(*angles);
+    const int n = VAR_DL+1;
+
+    int i, j, k, l, nl, m1[4], m2[4];
+    double* d = buf;
+    double* e = buf + n;
+    double* f = buf + 2*n;
+    struct wigner_dl_state st;
+    struct check ck, cr, cp, cx, cs, cg, cm, cd, cz;
+
+    check_begin(&cr, "dl kernels vs recurrence", 4);
+    check_begin(&cx, "dl general vs recurrence", 64);
+    check_begin(&cp, "legendre_pl vs recurrence", 2);
+    check_begin(&cs, "dl_state vs recurrence", 4);
+    check_begin(&ck, "dl_state == dl (kernels)", 0);
+    check_begin(&cg, "dl_segmented vs recurrence", 4);
+    check_begin(&cm, "dl_multi vs recurrence", 4);
+    check_begin(&cd, "dl_deriv vs recurrence", 64);
+    for(i = 0; i < nspins; ++i)
+    {
+        for(j = 0; j < nangles; ++j)
+        {
+            ref_dl_rec(VAR_DL, spins[i][0], spins[i][1], angles[j], ref);
+
+            if(i < nkernels)
+            {
+                TIMED(&cr, wigner_dl(0, VAR_DL, spins[i][0], spins[i][1],
+                                    angles[j], d));
+                check_row_dl(&cr, n, d, ref, angles[j]);
+            }
+            else if(i < nspins-1)
+            {
+                TIMED(&cx, wigner_dl(0, VAR_DL, spins[i][0], spins[i][1],
+                                    angles[j], d));
+                check_row_dl(&cx, n, d, ref, angles[j]);
+            }
+            else
+            {
+                TIMED(&cp, legendre_pl(0, VAR_DL, cos(angles[j]), d));
+                check_row_dl(&cp, n, d, ref, angles[j]);
+            }
+
+            // chunks of growing length
+            TIMED(&cs, wigner_dl_init(&st, spins[i][0], spins[i][1],
+                                     angles[j]);
+                      for(l = 0, nl = 1; l < n; l += nl, nl = 2*nl+1)
+                          wigner_dl_advance(&st, l+nl < n ? nl : n-l, e+l));
+            check_row_dl(&cs, n, e, ref, angles[j]);
+            if(i < nkernels)
+                for(l = 0; l < n; ++l)
+                    check_add(&ck, e[l], d[l], 0);
+
+            TIMED(&cg, wigner_dl_segmented(0, VAR_DL, spins[i][0],
+                                          spins[i][1], angles[j], f));
+            check_row_dl(&cg, n, f, ref, angles[j]);
+
+            TIMED(&cd, wigner_dl_deriv(0, VAR_DL, spins[i][0], spins[i][1],
+                                      angles[j], f, f+n));
+            check_row_dl(&cd, n, f, ref, angles[j]);
+
+            // together with other spins, interleaved
+            for(k = 0; k < 4; ++k)
+            {
+                m1[k] = spins[(i+3*k)%nspins][0];
+                m2[k] = spins[(i+3*k)%nspins][1];
+            }
+            TIMED(&cm, wigner_dl_multi(0, VAR_DL, 4, m1, m2, angles[j], 1,
+                                      f));
+            for(l = 0; l < n; ++l)
+                e[l] = f[4*l];
+            check_row_dl(&cm, n, e, ref, angles[j]);
+        }
+    }
+
+    // rows that end below the starting degree are all zero, and nothing is
+    // written past their end
+    check_begin(&cz, "dl rows below start", 0);
+    for(i = 0; i < nspins; ++i)
+    {
+        nl = abs(spins[i][0]) > abs(spins[i][1]) ? abs(spins[i][0])
+                                                 : abs(spins[i][1]);
+        for(k = 0; k < nl; ++k)
+        {
+            for(l = 0; l <= nl; ++l)
+                d[l] = e[l] = f[l] = 1;
+            wigner_dl(0, k, spins[i][0], spins[i][1], 1., d);
+            wigner_dl_deriv(0, k, spins[i][0], spins[i][1], 1., e, f);
+            for(l = 0; l <= nl; ++l)
+            {
+                check_add(&cz, d[l], l <= k ? 0 : 1, 0);
+                check_add(&cz, e[l], l <= k ? 0 : 1, 0);
+                check_add(&cz, f[l], l <= k ? 0 : 1, 0);
+            }
+        }
+    }
+    check_end(&cz);
+
+    check_end(&cr);
+    check_end(&cx);
+    check_end(&cp);
+    check_end(&cs);
+    check_end(&ck);
+    check_end(&cg);
+    check_end(&cm);
+    check_end(&cd);
+}
+
+// number of points of the spin-weighted harmonics, and the number of points
+// and largest degree of the check against the recurrence
+#define YLM_N 150
+#define YLM_NL 10
+#define YLM_LMAX 1000
+
+// arguments of spin_ylm and spin_synth on an execution context
+struct ylm_args
+{
+    int s, lmax, n;
+    const double* alm;
+    const double* theta;
+    const double* phi;
+};
+
+static int ylm_call(void* arg, const struct wigner_exec* exec, double* out)
+{
+    const struct ylm_args* a = arg;
+
+    return spin_ylm(a->s, a->lmax, WIGNER_ALM_LM, a->n, a->theta, a->phi, out,
+                    exec);
+}
+
+static int synth_call(void* arg, const struct wigner_exec* exec, double* out)
+{
+    const struct ylm_args* a = arg;
+
+    return spin_synth(a->s, a->lmax, WIGNER_ALM_LM, a->alm, a->n, a->theta,
+                      a->phi, out, exec);
+}
+
+// spin-weighted spherical harmonics against the reference d-functions, and
+// against the reference recurrence for large degrees
+static void test_spin_ylm(long double* ref)
+{
+    static const int spins[] = { 0, 1, -2, 3 };
+    const int nspins = sizeof(spins)/sizeof(*spins);
+
+    struct ylm_args a;
+    struct check c, cd, co, cy, ce, cz;
+    double theta[YLM_N], phi[YLM_N], thl[YLM_NL], phl[YLM_NL];
+    long double d, dd, f;
+    long double* tab;
+    double* y;
+    double* y2;
+    size_t nalm, size, i, j;
+    int k, s, l, m, p, ier;
+
+    tab = ref_delta();
+    size = 2*YLM_N*wigner_alm_size(WIGNER_ALM_LM, REF_DL);
+    i = 2*YLM_NL*wigner_alm_size(WIGNER_ALM_HEALPIX, YLM_LMAX);
+    if(i > size)
+        size = i;
+    y = malloc(2*size*sizeof(double));
+    if(!tab || !y)
+    {
+        free(tab);
+        free(y);
+        nfail += 1;
+        return;
+    }
+    y2 = y + size;
+
+    // points including both poles
+    for(p = 0; p < YLM_N; ++p)
+    {
+        theta[p] = PI*p/(YLM_N-1);
+        phi[p] = 2*PI*p/YLM_N + 0.1;
+    }
+
+    // points away from the poles for the large degrees, where the phases are
+    // compared with the argument m phi rounded to double as in the library
+    for(p = 0; p < YLM_NL; ++p)
+    {
+        thl[p] = theta[7+13*p];
+        phl[p] = phi[7+13*p];
+    }
+
+    check_begin(&c, "spin_ylm reference", 512);
+    check_begin(&co, "spin_ylm healpix == lm", 0);
+    check_begin(&cy, "spin_ylm conjugate", 16);
+    for(k = 0; k < nspins; ++k)
+    {
+        s = spins[k];
+        nalm = wigner_alm_size(WIGNER_ALM_LM, REF_DL);
+        TIMED(&c, ier = spin_ylm(s, REF_DL, WIGNER_ALM_LM, YLM_N, theta, phi,
+                                 y, NULL));
+        check_add(&c, ier, 0, 0);
+        for(p = 0; p < YLM_N; ++p)
+        {
+            for(l = 0; l <= REF_DL; ++l)
+            {
+                f = (odd(s) ? -1 : 1)*sqrtl((2*l+1)/(4*(long double)PI));
+                for(m = -l; m <= l; ++m)
+                {
+                    ref_dl(tab, l, m, -s, theta[p], &d, &dd);
+                    i = 2*(p*nalm + wigner_alm_index(WIGNER_ALM_LM, REF_DL,
+                                                     l, m));
+                    check_add(&c, y[i], f*d*cosl(m*(long double)phi[p]),
+                              (double)f);
+                    check_add(&c, y[i+1], f*d*sinl(m*(long double)phi[p]),
+                              (double)f);
+                }
+            }
+        }
+
+        // the ordering with m >= 0 only has the same values
+        spin_ylm(s, REF_DL, WIGNER_ALM_HEALPIX, YLM_N, theta, phi, y2, NULL);
+        j = wigner_alm_size(WIGNER_ALM_HEALPIX, REF_DL);
+        for(p = 0; p < YLM_N; ++p)
+        {
+            for(m = 0; m <= REF_DL; ++m)
+            {
+                for(l = m; l <= REF_DL; ++l)
+                {
+                    i = 2*(p*nalm + wigner_alm_index(WIGNER_ALM_LM, REF_DL,
+                                                     l, m));
+                    check_add(&co, y2[2*(p*j + wigner_alm_index(
+                                  WIGNER_ALM_HEALPIX, REF_DL, l, m))],
+                              y[i], 0);
+                    check_add(&co, y2[2*(p*j + wigner_alm_index(
+                                  WIGNER_ALM_HEALPIX, REF_DL, l, m))+1],
+                              y[i+1], 0);
+                }
+            }
+        }
+
+        // sY_lm^* = (-1)^(s+m) {-s}Y_{l,-m}
+        spin_ylm(-s, REF_DL, WIGNER_ALM_LM, YLM_N, theta, phi, y2, NULL);
+        for(p = 0; p < YLM_N; ++p)
+        {
+            for(l = 0; l <= REF_DL; ++l)
+            {
+                f = sqrtl((2*l+1)/(4*(long double)PI));
+                for(m = -l; m <= l; ++m)
+                {
+                    i = 2*(p*nalm + wigner_alm_index(WIGNER_ALM_LM, REF_DL,
+                                                     l, m));
+                    j = 2*(p*nalm + wigner_alm_index(WIGNER_ALM_LM, REF_DL,
+                                                     l, -m));
+                    check_add(&cy, y[i], (odd(s+m) ? -1 : 1)*y2[j],
+                              (double)f);
+                    check_add(&cy, y[i+1], (odd(s+m) ? 1 : -1)*y2[j+1],
+                              (double)f);
+                }
+            }
+        }
+    }
+    check_end(&c);
+    check_end(&co);
+    check_end(&cy);
+
+    // large degrees against the recurrence in long double
+    check_begin(&cd, "spin_ylm vs recurrence", 1024);
+    nalm = wigner_alm_size(WIGNER_ALM_HEALPIX, YLM_LMAX);
+    for(k = 0; k < nspins; ++k)
+    {
+        s = spins[k];
+        TIMED(&cd, ier = spin_ylm(s, YLM_LMAX, WIGNER_ALM_HEALPIX, YLM_NL,
+                                  thl, phl, y, NULL));
+        check_add(&cd, ier, 0, 0);
+        for(p = 0; p < YLM_NL; ++p)
+        {
+            for(m = 0; m <= YLM_LMAX; m += 37)
+            {
+                ref_dl_rec(YLM_LMAX, m, -s, thl[p], ref);
+                for(l = m > abs(s) ? m : abs(s); l <= YLM_LMAX; ++l)
+                {
+                    f = (odd(s) ? -1 : 1)*sqrtl((2*l+1)/(4*(long double)PI));
+                    i = 2*(p*nalm + wigner_alm_index(WIGNER_ALM_HEALPIX,
+                                                     YLM_LMAX, l, m));
+                    check_add(&cd, y[i], f*ref[l]*cosl(m*phl[p]), (double)f);
+                    check_add(&cd, y[i+1], f*ref[l]*sinl(m*phl[p]), (double)f);
+                }
+            }
+        }
+    }
+    check_end(&cd);
+
+    // spins larger than lmax, where all harmonics vanish, without writing
+    // past the modes of each point
+    check_begin(&cz, "spin_ylm |s| > lmax", 0);
+    for(k = 0; k < 2; ++k)
+    {
+        nalm = wigner_alm_size(WIGNER_ALM_LM, 2);
+        for(i = 0; i < 2*(YLM_N+1)*nalm; ++i)
+            y[i] = 1;
+        ier = spin_ylm(k ? -3 : 5, 2, WIGNER_ALM_LM, YLM_N, theta, phi, y,
+                       NULL);
+        check_add(&cz, ier, 0, 0);
+        for(i = 0; i < 2*YLM_N*nalm; ++i)
+            check_add(&cz, y[i], 0, 0);
+        for(; i < 2*(YLM_N+1)*nalm; ++i)
+            check_add(&cz, y[i], 1, 0);
+    }
+    check_end(&cz);
+
+    a.s = 2;
+    a.lmax = REF_DL;
+    a.n = YLM_N;
+    a.alm = NULL;
+    a.theta = theta;
+    a.phi = phi;
+    check_begin(&ce, "spin_ylm exec == default", 0);
+    check_exec(&ce, ylm_call, &a,
+               2*YLM_N*wigner_alm_size(WIGNER_ALM_LM, REF_DL), y, y2);
+    check_add(&ce, spin_ylm(0, -1, WIGNER_ALM_LM, 1, theta, phi, y, NULL), 2,
+              0);
+    check_add(&ce, spin_ylm(0, 10, 7, 1, theta, phi, y, NULL), 2, 0);
+    check_add(&ce, spin_ylm(0, 10, WIGNER_ALM_LM, 0, theta, phi, y, NULL), 0,
+              0);
+    for(i = 0; i < 8; ++i)
+        y[i] = 1;
+    spin_ylm(3, 1, WIGNER_ALM_LM, 1, theta+1, phi, y, NULL);
+    for(i = 0; i < 8; ++i)
+        check_add(&ce, y[i], 0, 0);
+    check_end(&ce);
+
+    free(y);
+    free(tab);
+}
+
+// largest degree of the synthesis
+#define SYNTH_LMAX 60
+
+// synthesis against the sums over the harmonics of spin_ylm
+static void test_spin_synth(void)
+{
+    static const int spins[] = { 0, 2, -1, 5 };
+    const int nspins = sizeof(spins)/sizeof(*spins);
+
+    struct ylm_args a;
+    struct check c, cr, ce;
+    double theta[YLM_N], phi[YLM_N], f[2*YLM_N], f2[2*YLM_N];
+    long double re, im, sum;
+    const double* b;
+    double* alm;
+    double* ext;
+    double* y;
+    size_t nalm, i, j;
+    int k, o, p, l, m, ier;
+
+    nalm = wigner_alm_size(WIGNER_ALM_LM, SYNTH_LMAX);
+    alm = malloc(2*nalm*(YLM_N+2)*sizeof(double));
+    if(!alm)
+    {
+        nfail += 1;
+        return;
+    }
+    ext = alm + 2*nalm;
+    y = ext + 2*nalm;
+
+    for(i = 0; i < 2*nalm; ++i)
+        alm[i] = cos(1.3*i)/(1 + 0.1*i);
+    for(p = 0; p < YLM_N; ++p)
+    {
+        theta[p] = PI*p/(YLM_N-1);
+        phi[p] = 2*PI*cos(3.7*p);
+    }
+
+    // the coefficients of the ordering WIGNER_ALM_HEALPIX for all m, with
+    // a_{l,-m} = (-1)^m a_lm^* and real a_l0
+    for(l = 0; l <= SYNTH_LMAX; ++l)
+    {
+        for(m = -l; m <= l; ++m)
+        {
+            i = 2*wigner_alm_index(WIGNER_ALM_LM, SYNTH_LMAX, l, m);
+            j = 2*wigner_alm_index(WIGNER_ALM_HEALPIX, SYNTH_LMAX, l, abs(m));
+            ext[i] = m < 0 && odd(m) ? -alm[j] : alm[j];
+            ext[i+1] = m < 0 && !odd(m) ? -alm[j+1] : m == 0 ? 0 : alm[j+1];
+        }
+    }
+
+    check_begin(&c, "spin_synth vs sum of ylm", 64);
+    check_begin(&cr, "spin_synth real field", 0);
+    for(k = 0; k < nspins; ++k)
+    {
+        spin_ylm(spins[k], SYNTH_LMAX, WIGNER_ALM_LM, YLM_N, theta, phi, y,
+                 NULL);
+        for(o = WIGNER_ALM_HEALPIX; o <= WIGNER_ALM_LM; ++o)
+        {
+            TIMED(&c, ier = spin_synth(spins[k], SYNTH_LMAX, o, alm, YLM_N,
+                                       theta, phi, f, NULL));
+            check_add(&c, ier, 0, 0);
+            b = o == WIGNER_ALM_LM ? alm : ext;
+            for(p = 0; p < YLM_N; ++p)
+            {
+                re = im = sum = 0;
+                for(i = 0; i < nalm; ++i)
+                {
+                    re += (long double)b[2*i]*y[2*(p*nalm+i)]
+                          - (long double)b[2*i+1]*y[2*(p*nalm+i)+1];
+                    im += (long double)b[2*i]*y[2*(p*nalm+i)+1]
+                          + (long double)b[2*i+1]*y[2*(p*nalm+i)];
+                    sum += hypotl(b[2*i], b[2*i+1])
+                           * hypotl(y[2*(p*nalm+i)], y[2*(p*nalm+i)+1]);
+                }
+                check_add(&c, f[2*p], re, (double)sum);
+                check_add(&c, f[2*p+1], im, (double)sum);
+                if(o == WIGNER_ALM_HEALPIX && spins[k] == 0)
+                    check_add(&cr, f[2*p+1], 0, 0);
+            }
+        }
+    }
+    check_end(&c);
+    check_end(&cr);
+
+    a.s = -2;
+    a.lmax = SYNTH_LMAX;
+    a.n = YLM_N;
+    a.alm = alm;
+    a.theta = theta;
+    a.phi = phi;
+    check_begin(&ce, "spin_synth exec == default", 0);
+    check_exec(&ce, synth_call, &a, 2*YLM_N, f, f2);
+    check_add(&ce, spin_synth(0, -1, WIGNER_ALM_LM, alm, 1, theta, phi, f,
+                              NULL), 2, 0);
+    check_add(&ce, spin_synth(0, 1, 7, alm, 1, theta, phi, f, NULL), 2, 0);
+    check_add(&ce, spin_synth(3, 1, WIGNER_ALM_LM, alm, 1, theta+1, phi, f,
+                              NULL), 0, 0);
+    check_add(&ce, f[0], 0, 0);
+    check_add(&ce, f[1], 0, 0);
+    check_end(&ce);
+
+    free(alm);
+}
+
+// largest degree of the rotations
+#define ROT_LMAX 40
+
+// rotation of the point (theta, phi) by R_z(gamma) R_y(beta) R_z(alpha)
+static void rotate_point(double alpha, double beta, double gamma,
+                         double* theta, double* phi)
+{
+    double x, y, z, t;
+
+    x = sin(*theta)*cos(*phi + alpha);
+    y = sin(*theta)*sin(*phi + alpha);
+    z = cos(*theta);
+    t = x*cos(beta) + z*sin(beta);
+    z = -x*sin(beta) + z*cos(beta);
+    x = t;
+    *theta = atan2(hypot(x, y), z);
+    *phi = atan2(y, x) + gamma;
+}
+
+// arguments of rotate_alm on an execution context, which rotates a copy of
+// the coefficients
+struct rotate_args
+{
+    int lmax;
+    double alpha, beta, gamma;
+    const double* alm;
+};
+
+static int rotate_call(void* arg, const struct wigner_exec* exec, double* out)
+{
+    const struct rotate_args* r = arg;
+    size_t i;
+
+    for(i = 0; i < 2*wigner_alm_size(WIGNER_ALM_LM, r->lmax); ++i)
+        out[i] = r->alm[i];
+    return rotate_alm(r->lmax, WIGNER_ALM_LM, r->alpha, r->beta, r->gamma,
+                      out, exec);
+}
+
+// rotated fields against the fields at the rotated points, and rotations
+// back and forth
+static void test_rotate_alm(void)
+{
+    static const double euler[][3] = {
+        { 0.3, 1.1, -2.0 }, { 0, 0, 1.5 }, { 2.5, PI, 0.1 }, { -1, 1e-3, 4 } };
+    const int neuler = sizeof(euler)/sizeof(*euler);
+
+    struct rotate_args r;
+    struct check c, cb, co, ce;
+    double theta[YLM_N], phi[YLM_N], th[YLM_N], ph[YLM_N];
+    double f[2*YLM_N], g[2*YLM_N], fmax;
+    double* alm;
+    double* blm;
+    double* hlm;
+    double* h2;
+    size_t nalm, i, j;
+    int k, l, m, p, ier;
+
+    nalm = wigner_alm_size(WIGNER_ALM_LM, ROT_LMAX);
+    alm = malloc(8*nalm*sizeof(double));
+    if(!alm)
+    {
+        nfail += 1;
+        return;
+    }
+    blm = alm + 2*nalm;
+    hlm = blm + 2*nalm;
+    h2 = hlm + 2*nalm;
+
+    // coefficients of a real field in both orderings
+    for(l = 0; l <= ROT_LMAX; ++l)
+    {
+        for(m = 0; m <= l; ++m)
+        {
+            i = 2*wigner_alm_index(WIGNER_ALM_LM, ROT_LMAX, l, m);
+            j = 2*wigner_alm_index(WIGNER_ALM_LM, ROT_LMAX, l, -m);
+            alm[i] = cos(1.7*i)/(1 + 0.1*l);
+            alm[i+1] = m > 0 ? sin(2.3*i)/(1 + 0.1*l) : 0;
+            alm[j] = m & 1 ? -alm[i] : alm[i];
+            alm[j+1] = m & 1 ? alm[i+1] : -alm[i+1];
+            j = 2*wigner_alm_index(WIGNER_ALM_HEALPIX, ROT_LMAX, l, m);
+            hlm[j] = alm[i];
+            hlm[j+1] = alm[i+1];
+        }
+    }
+
+    for(p = 0; p < YLM_N; ++p)
+    {
+        theta[p] = acos(1 - 2*(p + 0.5)/YLM_N);
+        phi[p] = fmod(2.4*p, 2*PI);
+    }
+
+    // the angle beta = 1e-3 loses some digits near the pole, as wigner_dl
+    check_begin(&c, "rotate_alm vs rotated points", 256);
+    check_begin(&cb, "rotate_alm back and forth", 256);
+    check_begin(&co, "rotate_alm healpix == lm", 0);
+    for(k = 0; k < neuler; ++k)
+    {
+        for(i = 0; i < 2*nalm; ++i)
+            blm[i] = alm[i];
+        TIMED(&c, ier = rotate_alm(ROT_LMAX, WIGNER_ALM_LM, euler[k][0],
+                                   euler[k][1], euler[k][2], blm, NULL));
+        check_add(&c, ier, 0, 0);
+
+        // field of the rotated coefficients against the field at the points
+        // moved by the inverse rotation
+        for(p = 0; p < YLM_N; ++p)
+        {
+            th[p] = theta[p];
+            ph[p] = phi[p];
+            rotate_point(-euler[k][0], -euler[k][1], -euler[k][2], &th[p],
+                         &ph[p]);
+        }
+        spin_synth(0, ROT_LMAX, WIGNER_ALM_LM, blm, YLM_N, theta, phi, f,
+                   NULL);
+        spin_synth(0, ROT_LMAX, WIGNER_ALM_LM, alm, YLM_N, th, ph, g, NULL);
+        fmax = 0;
+        for(p = 0; p < 2*YLM_N; ++p)
+            if(fabs(g[p]) > fmax)
+                fmax = fabs(g[p]);
+        for(p = 0; p < 2*YLM_N; ++p)
+            check_add(&c, f[p], g[p], fmax);
+
+        // the real field in the HEALPix ordering
+        for(i = 0; i < 2*wigner_alm_size(WIGNER_ALM_HEALPIX, ROT_LMAX); ++i)
+            h2[i] = hlm[i];
+        rotate_alm(ROT_LMAX, WIGNER_ALM_HEALPIX, euler[k][0], euler[k][1],
+                   euler[k][2], h2, NULL);
+        for(l = 0; l <= ROT_LMAX; ++l)
+        {
+            for(m = 0; m <= l; ++m)
+            {
+                i = 2*wigner_alm_index(WIGNER_ALM_LM, ROT_LMAX, l, m);
+                j = 2*wigner_alm_index(WIGNER_ALM_HEALPIX, ROT_LMAX, l, m);
+                check_add(&co, h2[j], blm[i], 0);
+                check_add(&co, h2[j+1], blm[i+1], 0);
+            }
+        }
+
+        // the inverse rotation
+        rotate_alm(ROT_LMAX, WIGNER_ALM_LM, -euler[k][2], -euler[k][1],
+                   -euler[k][0], blm, NULL);
+        for(i = 0; i < 2*nalm; ++i)
+            check_add(&cb, blm[i], alm[i], 1);
+    }
+    check_end(&c);
+    check_end(&cb);
+    check_end(&co);
+
+    r.lmax = ROT_LMAX;
+    r.alpha = 0.3;
+    r.beta = 1.1;
+    r.gamma = -2.0;
+    r.alm = alm;
+    check_begin(&ce, "rotate_alm exec == default", 0);
+    check_exec(&ce, rotate_call, &r, 2*nalm, hlm, blm);
+    check_add(&ce, rotate_alm(-1, WIGNER_ALM_LM, 0, 0, 0, blm, NULL), 2, 0);
+    check_add(&ce, rotate_alm(2, 7, 0, 0, 0, blm, NULL), 2, 0);
+    check_end(&ce);
+
+    free(alm);
+}
+
+// grid of the Legendre tiles
+#define TILE_N 1000
+#define TILE_LMAX 300
+
+// copies the tiles into the full grid, and counts tiles out of order
+struct tile_grid
+{
+    int xblock, lblock;
+    const double* x;
+    double* p;
+    int* next;
+    int nbad;
+};
+
+static void tile_copy(void* arg, int i0, int ni, int l0, int nl,
+                      const double* p)
+{
+    struct tile_grid* g = arg;
+    int i, l;
+
+    if(l0 != g->next[i0/g->xblock] || i0 % g->xblock)
+        g->nbad += 1;
+    g->next[i0/g->xblock] = l0 + nl;
+
+    for(l = 0; l < nl; ++l)
+        for(i = 0; i < ni; ++i)
+            g->p[(size_t)(i0+i)*(TILE_LMAX+1) + l0+l] = p[l*ni+i];
+}
+
+// legendre_pl_tiles on an execution context, into the full grid out
+static int tile_call(void* arg, const struct wigner_exec* exec, double* out)
+{
+    struct tile_grid* g = arg;
+    int i;
+
+    g->p = out;
+    for(i = 0; i < TILE_N; ++i)
+        g->next[i] = 0;
+    for(i = 0; i < TILE_N*(TILE_LMAX+1); ++i)
+        out[i] = -2;
+    return legendre_pl_tiles(TILE_LMAX, TILE_N, g->x, g->xblock, g->lblock,
+                             tile_copy, g, exec);
+}
+
+// tiles of Legendre polynomials against legendre_pl
+static void test_legendre_pl_tiles(void)
+{
+    static const int blocks[][2] = {
+        { 64, 50 }, { 1, 1 }, { 1000, 301 }, { 7, 400 }, { 333, 2 } };
+    const int nblocks = sizeof(blocks)/sizeof(*blocks);
+
+    struct tile_grid g;
+    struct check c;
+    double x[TILE_N];
+    double* p;
+    double* q;
+    int i, k;
+
+    p = malloc(3*(size_t)TILE_N*(TILE_LMAX+1)*sizeof(double));
+    g.next = malloc(TILE_N*sizeof(int));
+    if(!p || !g.next)
+    {
+        free(p);
+        free(g.next);
+        nfail += 1;
+        return;
+    }
+    q = p + (size_t)TILE_N*(TILE_LMAX+1);
+    g.x = x;
+
+    for(i = 0; i < TILE_N; ++i)
+    {
+        x[i] = cos(PI*(i + 0.5)/TILE_N);
+        legendre_pl(0, TILE_LMAX, x[i], p + (size_t)i*(TILE_LMAX+1));
+    }
+
+    // every block size on every execution context, against legendre_pl
+    check_begin(&c, "legendre_pl_tiles == pl", 0);
+    for(k = 0; k < nblocks; ++k)
+    {
+        g.xblock = blocks[k][0];
+        g.lblock = blocks[k][1];
+        g.nbad = 0;
+        check_exec(&c, tile_call, &g, (size_t)TILE_N*(TILE_LMAX+1), q,
+                   q + (size_t)TILE_N*(TILE_LMAX+1));
+        check_add(&c, g.nbad, 0, 0);
+        for(i = 0; i < TILE_N*(TILE_LMAX+1); ++i)
+            check_add(&c, q[i], p[i], 0);
+    }
+    check_add(&c, legendre_pl_tiles(-1, TILE_N, x, 1, 1, tile_copy, &g,
+                                    NULL), 2, 0);
+    check_add(&c, legendre_pl_tiles(TILE_LMAX, TILE_N, x, 0, 1, tile_copy,
+                                    &g, NULL), 2, 0);
+    check_add(&c, legendre_pl_tiles(TILE_LMAX, 0, x, 1, 1, tile_copy, &g,
+                                    NULL), 0, 0);
+    check_end(&c);
+
+    free(p);
+    free(g.next);
+}
+
+// largest degree of the associated Legendre functions, and the degree and
+// order of the check of scaled values near the pole
+#define PLM_LMAX 60
+#define PLM_LPOLE 8000
+#define PLM_MPOLE 300
+
+// unnormalised P_lm(x) for all l from m to lmax by the recurrence in long
+// double, where sin(theta)^m does not underflow
+static void ref_plm(int lmax, int m, long double x, long double* p)
+{
+    int l;
+    long double s;
+
+    s = sqrtl((1 - x)*(1 + x));
+    p[0] = 1;
+    for(l = 1; l <= m; ++l)
+        p[0] *= -(2*l-1)*s;
+    if(lmax > m)
+        p[1] = x*(2*m+1)*p[0];
+    for(l = m+2; l <= lmax; ++l)
+        p[l-m] = ((2*l-1)*x*p[l-m-1] - (l+m-1)*p[l-m-2])/(l-m);
+}
+
+// arguments of legendre_plm_all on an execution context
+struct plm_args
+{
+    int lmax, norm, n;
+    const double* x;
+};
+
+static int plm_call(void* arg, const struct wigner_exec* exec, double* out)
+{
+    const struct plm_args* a = arg;
+
+    return legendre_plm_all(a->lmax, a->norm, a->n, a->x, out, exec);
+}
+
+// associated Legendre functions in all normalisations against the recurrence
+// in long double, the spherical harmonics, and the addition theorem
+static void test_legendre_plm(double* buf, long double* ref)
+{
+    struct plm_args a;
+    struct check c, co, cs, cp, ca, ce;
+    double x[YLM_N], theta[YLM_N], phi[YLM_N], xp;
+    long double f, scale;
+    double* y;
+    double* q;
+    size_t nalm, i;
+    int k, p, l, m, ier;
+
+    nalm = wigner_alm_size(WIGNER_ALM_HEALPIX, PLM_LMAX);
+    y = malloc(4*YLM_N*nalm*sizeof(double));
+    if(!y)
+    {
+        nfail += 1;
+        return;
+    }
+    q = y + 2*YLM_N*nalm;
+
+    for(p = 0; p < YLM_N; ++p)
+    {
+        theta[p] = PI*p/(YLM_N-1);
+        x[p] = cos(theta[p]);
+        phi[p] = 0;
+    }
+
+    check_begin(&c, "legendre_plm unnorm ref", 256);
+    check_begin(&cs, "legendre_plm schmidt ref", 256);
+    check_begin(&co, "legendre_plm ortho ref", 256);
+    for(m = 0; m <= PLM_LMAX; ++m)
+    {
+        TIMED(&c, ier = legendre_plm(PLM_LMAX, m, LEGENDRE_PLM_UNNORM, YLM_N,
+                                     x, buf, NULL));
+        check_add(&c, ier, 0, 0);
+        legendre_plm(PLM_LMAX, m, LEGENDRE_PLM_SCHMIDT, YLM_N, x, q, NULL);
+        legendre_plm(PLM_LMAX, m, LEGENDRE_PLM_ORTHO, YLM_N, x, y, NULL);
+        for(p = 0; p < YLM_N; ++p)
+        {
+            ref_plm(PLM_LMAX, m, x[p], ref);
+            check_row(&c, PLM_LMAX-m+1, buf + p*(PLM_LMAX-m+1), ref);
+            for(l = m; l <= PLM_LMAX; ++l)
+            {
+                f = sqrtl(fact[l-m]/fact[l+m])*ref[l-m];
+                check_add(&cs, q[p*(PLM_LMAX-m+1)+l-m],
+                          (odd(m) ? -1 : 1)*sqrtl(m > 0 ? 2 : 1)*f, 1);
+                check_add(&co, y[p*(PLM_LMAX-m+1)+l-m],
+                          sqrtl((2*l+1)/(4*(long double)PI))*f, 1);
+            }
+        }
+    }
+    check_end(&c);
+    check_end(&cs);
+    check_end(&co);
+
+    // orthonormal functions are the spherical harmonics at phi = 0
+    check_begin(&co, "legendre_plm ortho == ylm", 1024);
+
+    TIMED(&co, ier = legendre_plm_all(PLM_LMAX, LEGENDRE_PLM_ORTHO, YLM_N, x,
+                                      q, NULL));
+    check_add(&co, ier, 0, 0);
+    spin_ylm(0, PLM_LMAX, WIGNER_ALM_HEALPIX, YLM_N, theta, phi, y, NULL);
+    for(i = 0; i < YLM_N*nalm; ++i)
+        check_add(&co, q[i], y[2*i], 1);
+    check_end(&co);
+
+    // sum over m of the squared Schmidt functions is one
+    check_begin(&ca, "legendre_plm schmidt sum", 256);
+    legendre_plm_all(PLM_LMAX, LEGENDRE_PLM_SCHMIDT, YLM_N, x, q, NULL);
+    for(p = 0; p < YLM_N; ++p)
+    {
+        for(l = 0; l <= PLM_LMAX; ++l)
+        {
+            f = 0;
+            for(m = 0; m <= l; ++m)
+            {
+                i = wigner_alm_index(WIGNER_ALM_HEALPIX, PLM_LMAX, l, m);
+                f += (long double)q[p*nalm+i]*q[p*nalm+i];
+            }
+            check_add(&ca, (double)f, 1, 1);
+        }
+    }
+    check_end(&ca);
+
+    // values below the range of double at the start of the recurrence, which
+    // are compared relative to the largest value up to each degree
+    check_begin(&cp, "legendre_plm near pole", 1024);
+    for(k = 0; k < 3; ++k)
+    {
+        xp = cos(0.01 + 0.02*k);
+        TIMED(&cp, ier = legendre_plm(PLM_LPOLE, PLM_MPOLE,
+                                      LEGENDRE_PLM_ORTHO, 1, &xp, buf, NULL));
+        check_add(&cp, ier, 0, 0);
+        ref_plm(PLM_LPOLE, PLM_MPOLE, xp, ref);
+        scale = 0;
+        for(l = PLM_MPOLE; l <= PLM_LPOLE; ++l)
+        {
+            f = ref[l-PLM_MPOLE]*sqrtl((2*l+1)/(4*(long double)PI))
+                * expl(0.5L*(lgammal(l-PLM_MPOLE+1) - lgammal(l+PLM_MPOLE+1)));
+            if(fabsl(f) > scale)
+                scale = fabsl(f);
+            if(scale >= DBL_MIN)
+                check_add(&cp, buf[l-PLM_MPOLE], f, (double)scale);
+        }
+    }
+    check_end(&cp);
+
+    // bit-identical results for every execution context, and for all m at
+    // once
+    a.lmax = PLM_LMAX;
+    a.norm = LEGENDRE_PLM_UNNORM;
+    a.n = YLM_N;
+    a.x = x;
+    check_begin(&ce, "legendre_plm exec and all", 0);
+    check_exec(&ce, plm_call, &a, YLM_N*nalm, q, y);
+    for(m = 0; m <= PLM_LMAX; m += 7)
+    {
+        legendre_plm(PLM_LMAX, m, LEGENDRE_PLM_UNNORM, YLM_N, x, buf, NULL);
+        for(p = 0; p < YLM_N; ++p)
+            for(l = m; l <= PLM_LMAX; ++l)
+                check_add(&ce, buf[p*(PLM_LMAX-m+1)+l-m],
+                          q[p*nalm + wigner_alm_index(WIGNER_ALM_HEALPIX,
+                                                      PLM_LMAX, l, m)], 0);
+    }
+    check_add(&ce, legendre_plm(PLM_LMAX, PLM_LMAX+1, LEGENDRE_PLM_ORTHO, 1,
+                                x, buf, NULL), 2, 0);
+    check_add(&ce, legendre_plm(PLM_LMAX, 0, 7, 1, x, buf, NULL), 2, 0);
+    check_add(&ce, legendre_plm_all(-1, LEGENDRE_PLM_ORTHO, 1, x, buf, NULL),
+              2, 0);
+    check_end(&ce);
+
+    free(y);
+}
+
+static void test_quadrature(double* buf)
+{
+    static const int ns[] = { 1, 2, 7, 64, 100, 1000, 3000 };
+    const int nns = sizeof(ns)/sizeof(*ns);
+    static const double bins[][2] = {
+        { 0, 1e-3 }, { 0.01, 0.02 }, { 1, 1.1 }, { 3, 3.14159 } };
+    const int nbins = sizeof(bins)/sizeof(*bins);
+    static const int spins[][2] = { { 2, -2 }, { 0, 2 }, { 3, 1 } };
+
+    struct wigner_dl_binavg_plan plan;
+    int i, j, k, l, n, ier;
+    double xa, xb, h;
+    long double c, y, p0, p1, p2;
+    long double* s;
+    double* x = buf;
+    double* w;
+    double* p;
+    struct check cq, cb, cp, ce;
+
+    s = malloc(2*ns[nns-1]*sizeof(long double));
+    if(!s)
+    {
+        nfail += 1;
+        return;
+    }
+
+    // sum_i w_i P_l(x_i) = 2 delta_{l,0} for l < 2n
+    check_begin(&cq, "gauss_legendre moments", 32);
+    for(i = 0; i < nns; ++i)
+    {
+        n = ns[i];
+        w = x + n;
+        p = w + n;
+        TIMED(&cq, gauss_legendre(n, x, w));
+        for(l = 0; l < 2*n; ++l)
+            s[l] = 0;
+        for(j = 0; j < n; ++j)
+        {
+            legendre_pl(0, 2*n-1, x[j], p);
+            for(l = 0; l < 2*n; ++l)
+                s[l] += (long double)w[j]*p[l];
+        }
+        for(l = 0; l < 2*n; ++l)
+            check_add(&cq, (double)s[l], l == 0 ? 2 : 0, 2);
+    }
+    check_end(&cq);
+
+    // bin averages against quadrature of legendre_pl in cos(theta)
+    check_begin(&cb, "legendre_pl_binavg vs quad", 16384);
+    n = 1000;
+    w = x + n;
+    p = w + n;
+    gauss_legendre(n, x, w);
+    for(k = 0; k < nbins; ++k)
+    {
+        xa = cos(bins[k][0]);
+        xb = cos(bins[k][1]);
+        h = 0.5*(xa - xb);
+        c = 0.5L*xa + 0.5L*xb;
+        for(l = 0; l <= 1000; ++l)
+            s[l] = 0;
+        for(j = 0; j < n; ++j)
+        {
+            // Legendre recurrence in long double
+            y = c + (long double)h*x[j];
+            p0 = 0;
+            p1 = 1;
+            for(l = 0; l <= 1000; ++l)
+            {
+                s[l] += 0.5L*w[j]*p1;
+                p2 = ((2*l+1)*y*p1 - l*p0)/(l+1);
+                p0 = p1;
+                p1 = p2;
+            }
+        }
+        TIMED(&cb, legendre_pl_binavg(0, 1000, xa, xb, p));
+        for(l = 0; l <= 1000; ++l)
+            check_add(&cb, p[l], s[l], 1);
+    }
+    check_end(&cb);
+
+    // a plan for the widest bin gives the averages of the narrower bins, up
+    // to the accuracy of wigner_dl near the poles, and those of
+    // wigner_dl_binavg for a bin of its own width, also for rows that start
+    // above l = 0
+    check_begin(&cp, "wigner_dl_binavg plan", 4096);
+    check_begin(&ce, "wigner_dl_binavg plan exact", 0);
+    ier = wigner_dl_binavg_init(&plan, 1000, bins[3][1] - bins[3][0]);
+    check_add(&cp, ier, 0, 0);
+    for(k = 0; k < nbins; ++k)
+    {
+        for(i = 0; i < 3; ++i)
+        {
+            ier = wigner_dl_binavg(0, 1000, spins[i][0], spins[i][1],
+                                   bins[k][0], bins[k][1], p);
+            check_add(&cp, ier, 0, 0);
+            TIMED(&cp, ier = wigner_dl_binavg_apply(&plan, 0, 1000,
+                                                    spins[i][0], spins[i][1],
+                                                    bins[k][0], bins[k][1],
+                                                    p+1001));
+            check_add(&cp, ier, 0, 0);
+            for(l = 0; l <= 1000; ++l)
+                check_add(&cp, p[1001+l], p[l], 1);
+            if(k == 3)
+                for(l = 0; l <= 1000; ++l)
+                    check_add(&ce, p[1001+l], p[l], 0);
+            ier = wigner_dl_binavg_apply(&plan, 700, 1000, spins[i][0],
+                                         spins[i][1], bins[k][0], bins[k][1],
+                                         p+1001);
+            check_add(&cp, ier, 0, 0);
+            for(l = 700; l <= 1000; ++l)
+                check_add(&cp, p[1001+l-700], p[l], 1);
+        }
+    }
+    check_add(&cp, wigner_dl_binavg_apply(&plan, 0, 1001, 2, 2, bins[3][0],
+                                          bins[3][1], p), 2, 0);
+    check_add(&cp, wigner_dl_binavg_apply(&plan, 0, 1000, 2, 2, 0, 1, p), 2,
+              0);
+    check_add(&cp, wigner_dl_binavg_apply(&plan, 10, 9, 2, 2, bins[2][0],
+                                          bins[2][1], p), 2, 0);
+    check_add(&cp, wigner_dl_binavg(10, 9, 2, 2, bins[2][0], bins[2][1], p),
+              2, 0);
+    wigner_dl_binavg_free(&plan);
+    check_end(&cp);
+    check_end(&ce);
+
+    free(s);
+}
+
+int main(void)
+{
+    int i;
+    double* buf;
+    long double* ref;
+
+    init_tables();
+
+    printf("%-28s %9s %10s %11s   %s\n", "check", "values", "time",
+           "per value", "largest error / tolerance [eps]");
+    printf("    %-5s", "ulp");
+    for(i = 0; i < NBINS-1; ++i)
+        printf(" %9g", ulp_edges[i]);
+    printf(" %9s\n", "larger");
+    printf("    %-5s", "rel");
+    for(i = 0; i < NBINS-1; ++i)
+        printf(" %9g", rel_edges[i]);
+    printf(" %9s\n", "larger");
+
+    buf = malloc(8*(VAR_DL+1)*sizeof(double));
+    ref = malloc(4*(VAR_DL+1)*sizeof(long double));
+    if(!buf || !ref)
+        return EXIT_FAILURE;
+
+    test_3j_reference(buf, ref);
+    test_6j_reference(buf, ref);
+    test_dl_reference(buf, ref);
+    test_3j_identities(buf);
+    test_6j_identities(buf);
+    test_single(buf);
+    test_batch(buf);
+    test_exec();
+    test_stats();
+    test_3j000(buf, ref);
+    test_dl_identities(buf);
+    test_dl_variants(buf, ref);
+    test_spin_ylm(ref);
+    test_spin_synth();
+    test_rotate_alm();
+    test_legendre_pl_tiles();
+    test_legendre_plm(buf, ref);
+    test_quadrature(buf);
+
+    free(buf);
+    free(ref);
+
+    if(nfail)
+        printf("%d checks failed\n", nfail);
+
+    return nfail ? EXIT_FAILURE : EXIT_SUCCESS;
+}
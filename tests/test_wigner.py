@@ -0,0 +1,396 @@
+# differential tests of the Python bindings
+#
+# notes:
+# - reference values for small l are exact: the Racah formulae for the 3j
+#   and 6j symbols and Wigner's formula for d^l(pi/2) are evaluated with
+#   Python integers, and the final square root is rounded only once
+# - for large l, identities are checked: the normalisation of rows of 3j and
+#   6j symbols, and the unitarity of the d matrix
+# - errors are measured in units of the machine epsilon times the largest
+#   reference value of each row, as in tests/test_wigner.c
+
+from fractions import Fraction
+from math import comb, factorial, isqrt, pi
+
+import numpy as np
+import pytest
+
+import wigner
+
+EPS = np.finfo(float).eps
+
+
+def binom(n, k):
+    return comb(n, k) if 0 <= k <= n else 0
+
+
+def sqrt_frac(r):
+    '''square root of a non-negative fraction, correctly rounded'''
+    s = isqrt((r.numerator << 256) // r.denominator)
+    return float(Fraction(s, 1 << 128))
+
+
+def signed_sqrt(s, r):
+    '''s*sqrt(r) for an integer s and a fraction r'''
+    return (1 if s > 0 else -1)*sqrt_frac(s*s*r) if s else 0.
+
+
+def ref_3j(tj1, tj2, tj3, tm1, tm2, tm3):
+    '''exact 3j symbol for doubled arguments'''
+    if (tm1 + tm2 + tm3 != 0 or (tj1 + tj2 + tj3) % 2 or tj3 < abs(tj1-tj2)
+            or tj3 > tj1 + tj2 or abs(tm1) > tj1 or abs(tm2) > tj2
+            or abs(tm3) > tj3 or (tj1 + tm1) % 2 or (tj2 + tm2) % 2):
+        return 0.
+    J = (tj1 + tj2 + tj3)//2
+    a, b, c = J - tj3, J - tj2, J - tj1
+    k1, k2 = (tj1 - tm1)//2, (tj2 + tm2)//2
+    s = sum((-1)**k*binom(a, k)*binom(b, k1-k)*binom(c, k2-k)
+            for k in range(a+1))
+    r = Fraction(binom(tj1, b)*binom(tj2, c),
+                 binom(J+1, a)*(tj3+1)*binom(tj1, k1)
+                 * binom(tj2, (tj2-tm2)//2)*binom(tj3, (tj3-tm3)//2))
+    return (-1)**((tj1-tj2-tm3)//2 % 2)*signed_sqrt(s, r)
+
+
+def ref_6j(tj1, tj2, tj3, tj4, tj5, tj6):
+    '''exact 6j symbol for doubled arguments'''
+    def tri(a, b, c):
+        if (a + b + c) % 2 or c < abs(a-b) or c > a+b:
+            return None
+        return Fraction(factorial((a+b-c)//2)*factorial((a-b+c)//2)
+                        * factorial((-a+b+c)//2), factorial((a+b+c)//2+1))
+    t = [tri(tj1, tj2, tj3), tri(tj1, tj5, tj6),
+         tri(tj4, tj2, tj6), tri(tj4, tj5, tj3)]
+    if None in t:
+        return 0.
+    a = [(tj1+tj2+tj3)//2, (tj1+tj5+tj6)//2,
+         (tj4+tj2+tj6)//2, (tj4+tj5+tj3)//2]
+    b = [(tj1+tj2+tj4+tj5)//2, (tj2+tj3+tj5+tj6)//2, (tj3+tj1+tj6+tj4)//2]
+    s = 0
+    for k in range(max(a), min(b)+1):
+        d = 1
+        for p in [k - x for x in a] + [x - k for x in b]:
+            d *= factorial(p)
+        s += (-1)**k*factorial(k+1)//d
+    return signed_sqrt(s, t[0]*t[1]*t[2]*t[3])
+
+
+def ref_dl_pi2(j, m1, m2):
+    '''exact d^j_{m1,m2}(pi/2) from Wigner's formula'''
+    s = sum((-1)**((m1-m2+k) % 2)*binom(j+m2, k)*binom(j-m2, j-m1-k)
+            for k in range(2*j+1))
+    r = Fraction(factorial(j+m1)*factorial(j-m1),
+                 factorial(j+m2)*factorial(j-m2)*4**j)
+    return signed_sqrt(s, r)
+
+
+def err(x, ref):
+    '''largest error in units of eps times the largest reference value'''
+    x, ref = np.asarray(x), np.asarray(ref)
+    scale = np.max(np.abs(ref)) if np.any(ref) else 1.
+    return np.max(np.abs(x - ref))/(EPS*scale)
+
+
+@pytest.mark.parametrize('tl2', range(0, 11))
+def test_3jj_reference(tl2):
+    worst = 0
+    for tl3 in range(0, 11):
+        for tm2 in range(-tl2, tl2+1, 2):
+            for tm3 in range(-tl3, tl3+1, 2):
+                l1min, l1max, x = wigner.wigner_3jj(tl2/2, tl3/2, tm2/2, tm3/2)
+                tm1 = -tm2 - tm3
+                ref = [ref_3j(tl1, tl2, tl3, tm1, tm2, tm3)
+                       for tl1 in range(int(2*l1min), int(2*l1max)+1, 2)]
+                worst = max(worst, err(x, ref))
+    assert worst <= 16
+
+
+def test_3jm_reference():
+    worst = 0
+    for tl1 in range(0, 9):
+        for tl2 in range(0, 9):
+            for tl3 in range(abs(tl1-tl2), min(tl1+tl2, 8)+1, 2):
+                for tm1 in range(-tl1, tl1+1, 2):
+                    m2min, m2max, x = wigner.wigner_3jm(tl1/2, tl2/2, tl3/2,
+                                                        tm1/2)
+                    ref = [ref_3j(tl1, tl2, tl3, tm1, tm2, -tm1-tm2)
+                           for tm2 in range(int(2*m2min), int(2*m2max)+1, 2)]
+                    worst = max(worst, err(x, ref))
+    assert worst <= 128
+
+
+def test_3j_block_reference():
+    worst = 0
+    for l1 in range(0, 6):
+        for l2 in range(0, 6):
+            for l3 in range(abs(l1-l2), l1+l2+1):
+                x = wigner.wigner_3j_block(l1, l2, l3)
+                ref = [[ref_3j(2*l1, 2*l2, 2*l3, 2*m1, 2*m2, -2*m1-2*m2)
+                        for m2 in range(-l2, l2+1)]
+                       for m1 in range(-l1, l1+1)]
+                worst = max(worst, err(x, ref))
+    assert worst <= 64
+
+
+def test_3j_single_reference():
+    worst = 0
+    for tl1 in range(0, 9):
+        for tl2 in range(0, 9):
+            for tl3 in range(abs(tl1-tl2), min(tl1+tl2, 8)+1, 2):
+                for tm1 in range(-tl1, tl1+1, 2):
+                    for tm2 in range(-tl2, tl2+1, 2):
+                        tm3 = -tm1 - tm2
+                        if abs(tm3) > tl3:
+                            continue
+                        x = wigner.wigner_3j_single(tl1/2, tl2/2, tl3/2,
+                                                    tm1/2, tm2/2, tm3/2)
+                        ref = ref_3j(tl1, tl2, tl3, tm1, tm2, tm3)
+                        worst = max(worst, abs(x - ref)/EPS)
+    assert worst <= 256
+
+
+def test_6j_reference():
+    worst = 0
+    r = range(0, 7)
+    for t2 in r:
+        for t3 in r:
+            for t4 in r:
+                for t5 in r:
+                    for t6 in r:
+                        try:
+                            l1min, l1max, x = wigner.wigner_6j(
+                                t2/2, t3/2, t4/2, t5/2, t6/2)
+                        except ValueError:
+                            continue
+                        ref = [ref_6j(t1, t2, t3, t4, t5, t6) for t1 in
+                               range(int(2*l1min), int(2*l1max)+1, 2)]
+                        worst = max(worst, err(x, ref))
+    assert worst <= 64
+
+
+@pytest.mark.parametrize('m1', [-3, 0, 1, 2, 4])
+@pytest.mark.parametrize('m2', [-4, -2, 0, 2, 3])
+def test_dl_reference(m1, m2):
+    # the angle pi/2 is rounded, which changes d^l by about l eps
+    lmax = 20
+    ref = [ref_dl_pi2(l, m1, m2) if l >= max(abs(m1), abs(m2)) else 0.
+           for l in range(lmax+1)]
+    assert err(wigner.wigner_dl(0, lmax, m1, m2, pi/2), ref) <= 1024
+    assert err(wigner.wigner_dl_deriv(0, lmax, m1, m2, pi/2)[0], ref) <= 1024
+    assert err(wigner.wigner_dl_multi(0, lmax, [m1, 0], [m2, 0], pi/2)[0],
+               ref) <= 1024
+
+
+@pytest.mark.parametrize('l2, l3, m2, m3', [
+    (50, 50, 0, 0), (300, 150, 150, -50), (1000, 10, 2, -2),
+    (2500, 1250.5, 3, -4.5), (99.5, 1000, 0.5, 0),
+])
+def test_3jj_normalisation(l2, l3, m2, m3):
+    l1min, l1max, x = wigner.wigner_3jj(l2, l3, m2, m3)
+    l1 = np.arange(l1min, l1max+1)
+    assert abs(np.sum((2*l1+1)*x**2) - 1) <= 64*EPS
+
+
+@pytest.mark.parametrize('l2, l3, l4, l5, l6', [
+    (500, 800, 300, 700, 600), (1000.5, 999.5, 700, 500.5, 600.5),
+    (2000, 2500, 10, 2495, 2003),
+])
+def test_6j_normalisation(l2, l3, l4, l5, l6):
+    l1min, l1max, x = wigner.wigner_6j(l2, l3, l4, l5, l6)
+    l1 = np.arange(l1min, l1max+1)
+    assert abs(np.sum((2*l1+1)*(2*l4+1)*x**2) - 1) <= 64*EPS
+
+
+@pytest.mark.parametrize('m1', [0, 2, -5])
+@pytest.mark.parametrize('theta', [1e-3, 1., 2.5])
+def test_dl_unitarity(m1, theta):
+    l = 200
+    d = np.array([wigner.wigner_dl(l, l, m1, m2, theta)[0]
+                  for m2 in range(-l, l+1)])
+    e = np.array([wigner.wigner_dl(l, l, m1+1, m2, theta)[0]
+                  for m2 in range(-l, l+1)])
+    assert abs(np.dot(d, d) - 1) <= 2**20*EPS
+    assert abs(np.dot(d, e)) <= 2**20*EPS
+
+
+@pytest.mark.parametrize('n', [1, 2, 7, 64, 100, 1000])
+def test_gauss_legendre(n):
+    x, w = wigner.gauss_legendre(n)
+    p = np.array([wigner.legendre_pl(0, 2*n-1, xi) for xi in x])
+    s = w @ p
+    s[0] -= 2
+    assert np.max(np.abs(s)) <= 64*EPS
+
+
+@pytest.mark.parametrize('m1, m2', [(0, 0), (2, 2), (2, -2), (0, 2), (3, 7)])
+@pytest.mark.parametrize('theta', [0.3, 1.5, 2.9])
+def test_dl_multi(m1, m2, theta):
+    d = wigner.wigner_dl(0, 2000, m1, m2, theta)
+    e = wigner.wigner_dl_multi(0, 2000, [m1, 0, 2], [m2, 0, -2], theta, True)
+    assert e.shape == (2001, 3)
+    assert err(e[:, 0], d) <= 2**14
+    # spins from numpy arrays of any integer type
+    for t in [np.int64, np.int32, np.int16]:
+        f = wigner.wigner_dl_multi(0, 2000, np.array([m1, 0, 2], dtype=t),
+                                   np.array([m2, 0, -2], dtype=t), theta,
+                                   True)
+        assert np.array_equal(f, e)
+    with pytest.raises(OverflowError):
+        wigner.wigner_dl_multi(0, 10, np.array([2**40]), np.array([0]), theta)
+
+
+def test_3j000():
+    lmax = 12
+    t = wigner.wigner_3j000(lmax)
+    n = 0
+    worst = 0
+    for l3 in range(lmax+1):
+        for l2 in range((l3+1)//2, l3+1):
+            for l1 in range(l3-l2, l2+1, 2):
+                i = wigner.wigner_3j000_index(l1, l2, l3)
+                assert i == n
+                ref = ref_3j(2*l1, 2*l2, 2*l3, 0, 0, 0)
+                worst = max(worst, abs(t[i] - ref)/EPS)
+                n += 1
+    assert n == len(t)
+    assert worst <= 16
+    with pytest.raises(ValueError):
+        wigner.wigner_3j000_index(1, 1, 1)
+
+
+def test_3j000_binned():
+    edges = [1, 5, 6, 17, 31]
+    lmax = edges[-1] - 1
+    l = np.arange(lmax+1)
+    w1, w2, w3 = 2*l + 1., np.cos(l), None
+    t = wigner.wigner_3j000(lmax)
+    nb = len(edges) - 1
+    ref = np.zeros((nb, nb, nb))
+    bins = np.digitize(l, edges) - 1
+    for l1 in range(edges[0], lmax+1):
+        for l2 in range(edges[0], lmax+1):
+            for l3 in range(edges[0], lmax+1):
+                s = sorted((l1, l2, l3))
+                if s[2] > s[0] + s[1] or sum(s) % 2:
+                    continue
+                x = t[wigner.wigner_3j000_index(*s)]
+                ref[bins[l1], bins[l2], bins[l3]] += x*x*w1[l1]*w2[l2]
+    out = wigner.wigner_3j000_binned(edges, w1, w2, w3)
+    assert out.shape == (nb, nb, nb)
+    assert np.max(np.abs(out - ref)) <= 64*EPS*np.max(np.abs(ref))
+    out = wigner.wigner_3j000_binned(np.array(edges), w1, w2, w3)
+    assert np.max(np.abs(out - ref)) <= 64*EPS*np.max(np.abs(ref))
+    out = wigner.wigner_3j000_binned(np.arange(0, 40, 10))
+    assert out.shape == (3, 3, 3)
+    with pytest.raises(ValueError):
+        wigner.wigner_3j000_binned([3, 2])
+    with pytest.raises(OverflowError):
+        wigner.wigner_3j000_binned(np.array([0, 2**40]))
+
+
+@pytest.mark.parametrize('s', [0, 1, -2])
+@pytest.mark.parametrize('order', ['healpix', 'lm'])
+def test_spin_ylm(s, order):
+    lmax = 10
+    phi = np.array([0., 0.3, 2., 5.])
+    y = wigner.spin_ylm(s, lmax, np.full(len(phi), pi/2), phi, order)
+    ms = range(0 if order == 'healpix' else -lmax, lmax+1)
+    ref = np.zeros(y.shape, dtype=complex)
+    for m in ms:
+        for l in range(max(abs(m), abs(s)), lmax+1):
+            i = (m*(2*lmax+1-m)//2 + l if order == 'healpix'
+                 else l*(l+1) + m)
+            ref[:, i] = ((-1)**s*np.sqrt((2*l+1)/(4*pi))
+                         * ref_dl_pi2(l, m, -s)*np.exp(1j*m*phi))
+    assert y.shape == (len(phi), (lmax+1)*(lmax+2)//2 if order == 'healpix'
+                       else (lmax+1)**2)
+    assert err(y, ref) <= 64
+    y = wigner.spin_ylm(0, 1, [0.7], [0.], order)
+    assert abs(y[0, 1 if order == 'healpix' else 2]
+               - np.sqrt(3/(4*pi))*np.cos(0.7)) <= 4*EPS
+    with pytest.raises(ValueError):
+        wigner.spin_ylm(s, lmax, [0.], [0., 1.], order)
+    with pytest.raises(ValueError):
+        wigner.spin_ylm(s, lmax, [0.], [0.], 'ring')
+
+
+@pytest.mark.parametrize('s', [0, 2])
+@pytest.mark.parametrize('order', ['healpix', 'lm'])
+def test_spin_synth(s, order):
+    lmax = 20
+    rng = np.random.default_rng(5)
+    theta = np.arccos(rng.uniform(-1, 1, 300))
+    phi = rng.uniform(0, 2*pi, 300)
+    y = wigner.spin_ylm(s, lmax, theta, phi, order)
+    alm = rng.normal(size=y.shape[1]) + 1j*rng.normal(size=y.shape[1])
+    f = wigner.spin_synth(s, lmax, alm, theta, phi, order)
+    b = alm
+    if order == 'healpix':
+        # all m, with a_{l,-m} = (-1)^m a_lm^* and real a_l0
+        y = wigner.spin_ylm(s, lmax, theta, phi, 'lm')
+        b = np.zeros((lmax+1)**2, dtype=complex)
+        for l in range(lmax+1):
+            b[l*(l+1)] = alm[l].real
+            for m in range(1, l+1):
+                b[l*(l+1)+m] = alm[m*(2*lmax+1-m)//2 + l]
+                b[l*(l+1)-m] = (-1)**m*np.conj(b[l*(l+1)+m])
+        if s == 0:
+            assert np.all(f.imag == 0)
+    ref = y @ b
+    assert f.shape == (300,)
+    assert np.max(np.abs(f - ref)) <= 256*EPS*np.max(np.abs(y) @ np.abs(b))
+    with pytest.raises(ValueError):
+        wigner.spin_synth(s, lmax, alm[1:], theta, phi, order)
+
+
+@pytest.mark.parametrize('order', ['healpix', 'lm'])
+def test_rotate_alm(order):
+    lmax = 16
+    rng = np.random.default_rng(7)
+    theta = np.arccos(rng.uniform(-1, 1, 100))
+    phi = rng.uniform(0, 2*pi, 100)
+    y = wigner.spin_ylm(0, lmax, theta, phi, 'lm')
+    alm = rng.normal(size=y.shape[1]) + 1j*rng.normal(size=y.shape[1])
+    if order == 'healpix':
+        alm = np.array([alm[l*(l+1)+m] for m in range(lmax+1)
+                        for l in range(m, lmax+1)])
+        alm[:lmax+1] = alm[:lmax+1].real
+    blm = wigner.rotate_alm(lmax, 0.3, 1.2, -0.7, alm, order)
+    assert blm.shape == alm.shape
+    # a rotation about z by alpha multiplies by exp(-i m alpha)
+    m = (np.concatenate([np.full(lmax+1-m, m) for m in range(lmax+1)])
+         if order == 'healpix' else
+         np.concatenate([np.arange(-l, l+1) for l in range(lmax+1)]))
+    zlm = wigner.rotate_alm(lmax, 0.5, 0., 0., alm, order)
+    assert (np.max(np.abs(zlm - alm*np.exp(-0.5j*m)))
+            <= 16*EPS*np.max(np.abs(alm)))
+    # back and forth
+    clm = wigner.rotate_alm(lmax, 0.7, -1.2, -0.3, blm, order)
+    assert np.max(np.abs(clm - alm)) <= 256*EPS*np.max(np.abs(alm))
+    with pytest.raises(ValueError):
+        wigner.rotate_alm(lmax, 0., 0., 0., alm[1:], order)
+
+
+@pytest.mark.parametrize('norm', ['ortho', 'schmidt', 'unnorm'])
+def test_legendre_plm(norm):
+    lmax = 12
+    x = np.linspace(-1, 1, 41)
+    s = np.sqrt((1 - x)*(1 + x))
+    p = wigner.legendre_plm_all(lmax, x, norm)
+    assert p.shape == (len(x), (lmax+1)*(lmax+2)//2)
+    for m in range(lmax+1):
+        pm = wigner.legendre_plm(lmax, m, x, norm)
+        assert np.array_equal(pm, p[:, m*(2*lmax+1-m)//2+m:][:, :lmax-m+1])
+    # closed forms of P_11 and P_22 without normalisation
+    f = {'ortho': [-np.sqrt(3/(8*pi)), np.sqrt(15/(32*pi))],
+         'schmidt': [1, np.sqrt(3)/2], 'unnorm': [-1, 3]}[norm]
+    assert err(p[:, lmax+1], f[0]*s) <= 4
+    assert err(p[:, 2*lmax+1], f[1]*s**2) <= 4
+    if norm == 'schmidt':
+        for l in range(lmax+1):
+            i = [m*(2*lmax+1-m)//2 + l for m in range(l+1)]
+            assert np.max(np.abs(np.sum(p[:, i]**2, axis=1) - 1)) <= 64*EPS
+    with pytest.raises(ValueError):
+        wigner.legendre_plm(lmax, lmax+1, x, norm)
+    with pytest.raises(ValueError):
+        wigner.legendre_plm(lmax, 0, x, 'full')